@@ -2,6 +2,8 @@
 #include <Arduino.h>
 
 #include "CircleText.h"
+#include "Gesture.h"
+#include "KeyMachine.h"
 
 // ===================== BLE =====================
 namespace Cfg {
@@ -10,6 +12,38 @@ namespace Cfg {
     static constexpr const char* CHARACTERISTIC_UUID = "beb5483e-36e1-4688-b7f5-ea07361b26a8";
 }
 
+// ===================== BLE TX batching =====================
+namespace BleTxCfg {
+    static constexpr uint16_t LOCAL_MTU    = 247;   // offered; the phone picks the final value
+    // records wait at most one connection interval, clamped to this range
+    static constexpr uint16_t FLUSH_MIN_MS = 8;
+    static constexpr uint16_t FLUSH_MAX_MS = 30;
+
+    // records waiting for link credits; powers of two
+    static constexpr uint32_t CONTROL_SLOTS   = 32;
+    static constexpr uint32_t TELEMETRY_SLOTS = 16;
+}
+
+// ===================== BLE RX =====================
+namespace RxCfg {
+    static constexpr uint32_t SLOTS    = 8;     // power of two
+    static constexpr uint16_t SLOT_LEN = 160;   // '\n'-separated messages; a longer write takes several slots
+}
+
+// ===================== Vehicle properties =====================
+// GIB:* ids are the phone's own property ids; FB:* feedback gets local ids
+// above the int32 range the phone uses.
+namespace PropCfg {
+    static constexpr uint32_t HVAC_FUNC_TEMP      = 268828928;   // IHvac.HVAC_FUNC_TEMP, Fixed
+    static constexpr uint32_t FB_REAR_DEFROST     = 0xFB000001;  // area 0, Int 0/1
+    static constexpr uint32_t FB_ELECTRIC_DEFROST = 0xFB000002;  // area 0, Int 0/1
+    static constexpr uint32_t FB_FAN_LEVEL        = 0xFB000003;  // area = fan area, Text
+    static constexpr uint32_t FB_FAN_AREA         = 0xFB000004;  // area 0, Int, last area reported
+
+    static constexpr int32_t AREA_MAIN = 1;
+    static constexpr int32_t AREA_PASS = 4;
+}
+
 // ===================== Pins =====================
 namespace Pins {
     // TFT (GC9A01 SPI)
@@ -43,38 +77,163 @@ namespace Pins {
     static constexpr int ENC2_B = 16;
 }
 
+// ===================== TFT =====================
+namespace TftCfg {
+    static constexpr int16_t W = 240;
+    static constexpr int16_t H = 240;
+
+    // Off-screen RGB565 band for the status/bottom text zones (internal RAM).
+    // Sized for the widest chord of a ~50 px zone: 194 x 49 on the 118 px circle.
+    static constexpr bool     USE_BAND_CANVAS = true;
+    static constexpr uint32_t BAND_BUF_PX     = 200 * 50;
+}
+
+// ===================== Render task =====================
+namespace RenderCfg {
+    static constexpr uint32_t QUEUE_LEN  = 16;    // power of two
+    static constexpr int      TASK_CORE  = 0;     // loop() runs on core 1
+    static constexpr uint32_t TASK_STACK = 4096;
+    static constexpr uint8_t  TASK_PRIO  = 1;
+}
+
+// ===================== Frame pacing =====================
+namespace FrameCfg {
+    static constexpr uint16_t TFT_FPS  = 25;
+    static constexpr uint16_t OLED_FPS = 10;
+    // I2C time loop() may spend per pass sending the OLED frame
+    static constexpr uint32_t LOOP_DRAW_BUDGET_US = 4000;
+}
+
 // ===================== OLED =====================
 namespace OledCfg {
     static constexpr int W = 128;
     static constexpr int H = 64;
+    static constexpr int HEADER_H = 16;   // two status lines above the log
+
+    // same defaults the Adafruit driver uses: fast while writing, slow after
+    static constexpr uint32_t I2C_HZ       = 400000;
+    static constexpr uint32_t I2C_HZ_AFTER = 100000;
+    // page bytes per loop pass: ~9 clocks per byte with the ACK
+    static constexpr uint32_t FLUSH_BYTES = FrameCfg::LOOP_DRAW_BUDGET_US * (I2C_HZ / 1000) / 9 / 1000;
     // базовые кандидаты; фактический адрес выбирается после i2cScan()
     static constexpr uint8_t AddrCandidates[] = {0x3C, 0x3D, 0x03, 0x3F};
 }
 
+// ===================== Encoder key timings =====================
+namespace EncCfg {
+    static constexpr uint16_t KEY_LONG_MS     = 450;
+
+    // PCNT decoding; falls back to the interrupt-driven library if a unit
+    // can't be configured
+    static constexpr bool     USE_PCNT         = true;
+    static constexpr uint8_t  COUNTS_PER_DETENT = 4;      // x4 quadrature
+    static constexpr uint16_t PCNT_FILTER_APB  = 800;    // 10 us at 80 MHz
+
+    // steps inside the window go out as one EVT:TEMP_x:+n; 0 = send at once
+    static constexpr uint16_t COALESCE_MS[2] = {40, 40};
+
+    // optional acceleration: detents in one window -> multiplier
+    struct AccelPoint { uint8_t steps; uint8_t mul; };
+    static constexpr AccelPoint ACCEL_CURVE[] = {{1, 1}, {3, 2}, {6, 4}};
+    static constexpr bool ACCEL[2] = {false, false};
+}
+
 // ===================== Buttons / MUX mapping =====================
 namespace BtnCfg {
     static constexpr uint8_t BTN_FIRST_CH = 0;
     static constexpr uint8_t BTN_COUNT    = 16;
 
-    // Encoder keys (через индексы в readButtonPressedByIndex(idx))
+    // Encoder keys (индексы каналов MUX, KeySampler)
     static constexpr uint8_t ENC1_KEY_IDX = 1;
     static constexpr uint8_t ENC2_KEY_IDX = 2;
 
-    static constexpr uint16_t DEBOUNCE_MS = 30;
+    // one sampler debounces every key, buttons and encoder keys alike
+    static constexpr uint16_t DEBOUNCE_MS = 25;
     static constexpr uint16_t LONG_MS     = 450;
+
+    // timer sampler; the 2-bit vertical counter flips after 4 equal samples
+    static constexpr uint32_t SAMPLE_US   = DEBOUNCE_MS * 1000UL / 4;
+    // nothing pressed for a while -> slow sampling; any change speeds it back up
+    static constexpr uint32_t SAMPLE_IDLE_US       = 20000;
+    static constexpr uint16_t SAMPLE_IDLE_AFTER_MS = 1000;
+    static constexpr uint32_t EDGE_QUEUE  = 32;   // power of two
+
+    // {longMs, doubleMs, repeatDelayMs, repeatStartMs, repeatMinMs, repeatStepPct}
+    // KEY_CLICK_LONG is the wire behaviour clients know: click on release,
+    // LONG after LONG_MS. Double click and auto-repeat change what a key
+    // sends (a click waits for doubleMs; repeat replaces LONG), so opt in per key.
+    static constexpr KeySpec KEY_CLICK_LONG = {LONG_MS, 0, 0, 0, 0, 0};
+    static constexpr KeySpec KEY_DOUBLE     = {LONG_MS, 300, 0, 0, 0, 0};
+    static constexpr KeySpec KEY_REPEAT     = {0, 0, 400, 250, 60, 15};
+    static constexpr KeySpec KEY_ENC        = {EncCfg::KEY_LONG_MS, 0, 0, 0, 0, 0};
+
+    static constexpr KeySpec KEYS[BTN_COUNT] = {
+            KEY_CLICK_LONG,   // C0, nothing connected yet
+            KEY_ENC,          // enc1 key
+            KEY_ENC,          // enc2 key
+            KEY_CLICK_LONG,   // d3 FAN +1 (KEY_REPEAT to hold for repeats)
+            KEY_CLICK_LONG,   // d4 FAN -1
+            KEY_CLICK_LONG,   // d5
+            KEY_CLICK_LONG,   // d6
+            KEY_CLICK_LONG,   // d7
+            KEY_CLICK_LONG,   // d8
+            KEY_CLICK_LONG,   // d9
+            KEY_CLICK_LONG,   // d10
+            KEY_CLICK_LONG,   // d11
+            KEY_CLICK_LONG,   // d12
+            KEY_CLICK_LONG,   // d13
+            KEY_CLICK_LONG,   // d14
+            KEY_CLICK_LONG,   // d15
+    };
 }
 
-// ===================== Encoder key timings =====================
-namespace EncCfg {
-    static constexpr uint16_t KEY_LONG_MS     = 450;
-    static constexpr uint16_t KEY_DEBOUNCE_MS = 25;
+// ===================== MUX scan =====================
+namespace MuxCfg {
+    // register select + cycle-counted settle; false = old digitalWrite path
+    static constexpr bool     FAST_SELECT = true;
+    // SIG settle after a select change. Pull-up rise through the 4067 is the
+    // slow edge; check DIAG:MUX settle_err on hardware before lowering it.
+    static constexpr uint16_t SETTLE_NS   = 3000;
+    static constexpr uint8_t  BOOT_SETTLE_CHECKS = 8;   // fast/slow scan pairs in setup()
+    static constexpr uint16_t LEGACY_SETTLE_US = 8;
 }
 
 // ===================== Touch timings =====================
 namespace TouchCfg {
+    static constexpr bool     USE_INT       = true;  // false: poll over I2C every loop
     static constexpr uint16_t UP_TIMEOUT_MS = 250;
     static constexpr uint16_t LOG_MIN_MS    = 80;
     static constexpr uint16_t LOG_MIN_DIST  = 6;   // Manhattan sum
+
+    // raw EVT:TOUCH:X=..,Y=.. stream while dragging, which phone clients
+    // already read; gestures are sent either way
+    static constexpr bool     RAW_XY        = true;
+
+    // {cx, cy, tapSlop, longMs, swipeMin, rotMinR, rotMinDeg, rotRoundPct}
+    static constexpr GestureCfg GESTURE = {120, 120, 10, 600, 40, 40, 45, 80};
+
+    static constexpr int16_t  TRAIL_RADIUS  = 3;   // half thickness of the drawn trail
+
+    // fixed-width "X:nnn Y:nnn" readout, built-in font
+    static constexpr uint8_t  XY_SIZE   = 2;
+    static constexpr uint8_t  XY_CHARS  = 11;
+    static constexpr int16_t  XY_FIELD_Y = 196;
+    static constexpr int16_t  XY_FIELD_X = 120 - XY_CHARS * 6 * XY_SIZE / 2;
+}
+
+// ===================== Main loop =====================
+namespace LoopCfg {
+    // loop() blocks between events; the poll cap covers what has no wake
+    // source (PCNT encoders, key/gesture timers)
+    static constexpr uint16_t ACTIVE_POLL_MS = 2;
+    static constexpr uint16_t IDLE_POLL_MS   = 20;
+    static constexpr uint16_t ACTIVE_HOLD_MS = 1000;   // after the last input
+}
+
+// ===================== Input events =====================
+namespace InputCfg {
+    static constexpr uint32_t QUEUE_LEN         = 32;   // power of two
+    static constexpr uint8_t  DISPATCH_PER_LOOP = 8;    // rest waits for the next loop
 }
 
 // ===================== Logger buffer sizes =====================
@@ -83,6 +242,12 @@ namespace LogCfg {
     static constexpr uint8_t  LEN   = 32;
 }
 
+// ===================== Diagnostics =====================
+namespace DiagCfg {
+    static constexpr bool     ENABLED   = false;   // DIAG:* report on Serial, for bench builds
+    static constexpr uint32_t REPORT_MS = 10000;
+}
+
 // ===================== Event strings + форматтеры =====================
 namespace Evt {
     // статические
@@ -147,6 +312,13 @@ namespace Evt {
         return (delta > 0) ? ENC2_P : ENC2_M;
     }
 
+    // ±1 stays a static string, larger deltas are formatted into out
+    static inline const char* encDelta(char* out, size_t n, uint8_t enc, long delta) {
+        if (delta == 1 || delta == -1) return encStep(enc, delta);
+        snprintf(out, n, "EVT:%s:%+ld", (enc == 1) ? "TEMP_MAIN" : "TEMP_PASS", delta);
+        return out;
+    }
+
     static inline const char* btnLongByIdx(uint8_t idx) {
         if (idx >= BtnCfg::BTN_COUNT) return "EVT:BTN:UNKNOWN:LONG";
         return BTN_LONG[idx];
@@ -163,6 +335,19 @@ namespace Evt {
     }
 
     // динамические
+    static inline void gesture(char* out, size_t n, const char* name, int16_t v) {
+        snprintf(out, n, "EVT:GEST:%s:%d", name, v);
+    }
+
+    static inline void gestureAt(char* out, size_t n, const char* name, int16_t x, int16_t y) {
+        snprintf(out, n, "EVT:GEST:%s:X=%d,Y=%d", name, x, y);
+    }
+
+    static inline const char* btnDoubleByIdx(char* out, size_t n, uint8_t idx) {
+        snprintf(out, n, "EVT:BTN:C%u:DOUBLE", (unsigned)idx);
+        return out;
+    }
+
     static inline void touchXY(char* out, size_t n, int16_t x, int16_t y) {
         snprintf(out, n, "EVT:TOUCH:X=%d,Y=%d", x, y);
     }
@@ -174,10 +359,14 @@ namespace Evt {
 
 // ===================== TFT circle text configs =====================
 namespace TftTextCfg {
+    // GC9A01 240x240, chord table built at compile time
+    inline constexpr CircleGeometry Round{120, 120, 118};
+
     // Строка статуса сверху (как твой tftTopStatus, но под круг)
     static inline CircleTextConfig Status() {
         CircleTextConfig c;
-        c.cx = 120; c.cy = 120; c.r = 118;
+        c.cx = Round.cx(); c.cy = Round.cy(); c.r = Round.r();
+        c.geometry = &Round;
 
         // зона текста: верхняя "шапка"
         c.topY = 6;
@@ -190,20 +379,4 @@ namespace TftTextCfg {
         c.color = 0xFFFF; // white
         return c;
     }
-
-    // Нижняя зона под координаты/подсказки
-    static inline CircleTextConfig Bottom() {
-        CircleTextConfig c;
-        c.cx = 120; c.cy = 120; c.r = 118;
-
-        c.topY = 188;
-        c.bottomY = 236;
-
-        c.margin = 8;
-        c.lineGap = 2;
-
-        c.textSize = 2;
-        c.color = 0xFFFF;
-        return c;
-    }
 }
\ No newline at end of file
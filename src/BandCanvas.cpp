@@ -0,0 +1,81 @@
+#include "BandCanvas.h"
+
+BandCanvas::BandCanvas(int16_t screenW, int16_t screenH, uint16_t* buf, uint32_t capacityPx)
+    : Adafruit_GFX(screenW, screenH), buf_(buf), capacity_(capacityPx) {}
+
+bool BandCanvas::setWindow(int16_t x, int16_t y, int16_t w, int16_t h) {
+    if (w <= 0 || h <= 0) return false;
+    if ((uint32_t)w * (uint32_t)h > capacity_) return false;
+    wx_ = x;
+    wy_ = y;
+    ww_ = w;
+    wh_ = h;
+    return true;
+}
+
+void BandCanvas::drawPixel(int16_t x, int16_t y, uint16_t color) {
+    x -= wx_;
+    y -= wy_;
+    if (x < 0 || y < 0 || x >= ww_ || y >= wh_) return;
+    buf_[(int32_t)y * ww_ + x] = color;
+}
+
+void BandCanvas::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    fillRect(x, y, w, h, color);
+}
+
+void BandCanvas::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    int16_t x0 = x - wx_, y0 = y - wy_;
+    int16_t x1 = x0 + w, y1 = y0 + h;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > ww_) x1 = ww_;
+    if (y1 > wh_) y1 = wh_;
+    if (x0 >= x1 || y0 >= y1) return;
+
+    for (int16_t yy = y0; yy < y1; yy++) {
+        uint16_t* row = buf_ + (int32_t)yy * ww_;
+        for (int16_t xx = x0; xx < x1; xx++) row[xx] = color;
+    }
+}
+
+void BandCanvas::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void BandCanvas::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+void BandCanvas::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    fillRect(x, y, w, 1, color);
+}
+
+void BandCanvas::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    fillRect(x, y, 1, h, color);
+}
+
+void BandCanvas::fillScreen(uint16_t color) {
+    fillRect(wx_, wy_, ww_, wh_, color);
+}
+
+uint32_t BandCanvas::push(Adafruit_SPITFT& tft, int16_t x, int16_t y, int16_t w, int16_t h) {
+    int16_t x0 = x - wx_, y0 = y - wy_;
+    int16_t x1 = x0 + w, y1 = y0 + h;
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 > ww_) x1 = ww_;
+    if (y1 > wh_) y1 = wh_;
+    if (x0 >= x1 || y0 >= y1) return 0;
+
+    const int16_t pw = x1 - x0;
+    const int16_t ph = y1 - y0;
+
+    tft.startWrite();
+    tft.setAddrWindow(wx_ + x0, wy_ + y0, pw, ph);
+    for (int16_t yy = y0; yy < y1; yy++) {
+        tft.writePixels(buf_ + (int32_t)yy * ww_ + x0, pw);
+    }
+    tft.endWrite();
+    return (uint32_t)pw * (uint32_t)ph;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SPITFT.h>
+
+// Off-screen RGB565 strip of the panel. Drawing uses screen coordinates;
+// anything outside the current window is dropped. The pixel buffer is
+// supplied by the caller (static, internal RAM) - nothing is allocated.
+class BandCanvas : public Adafruit_GFX {
+public:
+    BandCanvas(int16_t screenW, int16_t screenH, uint16_t* buf, uint32_t capacityPx);
+
+    // Select the screen area backed by the buffer; false if it doesn't fit
+    bool setWindow(int16_t x, int16_t y, int16_t w, int16_t h);
+
+    int16_t windowX() const { return wx_; }
+    int16_t windowY() const { return wy_; }
+    int16_t windowW() const { return ww_; }
+    int16_t windowH() const { return wh_; }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) override;
+    void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override;
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override;
+    void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override;
+    void fillScreen(uint16_t color) override;  // fills the window only
+
+    // Send the part of the window inside (x, y, w, h) to the panel as one
+    // address window / one SPI transaction. Returns pixels sent.
+    uint32_t push(Adafruit_SPITFT& tft, int16_t x, int16_t y, int16_t w, int16_t h);
+
+private:
+    uint16_t* buf_;
+    uint32_t capacity_;
+    int16_t wx_ = 0, wy_ = 0, ww_ = 0, wh_ = 0;
+};
@@ -0,0 +1,77 @@
+#include "BinProto.h"
+#include <string.h>
+
+namespace BinProto {
+
+size_t putVarint(uint8_t* out, size_t cap, uint32_t v) {
+    size_t i = 0;
+    do {
+        if (i >= cap) return 0;
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        out[i++] = v ? (b | 0x80) : b;
+    } while (v);
+    return i;
+}
+
+size_t getVarint(const uint8_t* in, size_t n, uint32_t* v) {
+    uint32_t r = 0;
+    for (size_t i = 0; i < n && i < VARINT_MAX; i++) {
+        r |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if (!(in[i] & 0x80)) {
+            *v = r;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+size_t encode(uint8_t* out, size_t cap, uint8_t op, uint8_t seq, const int32_t* args, uint8_t argc) {
+    if (cap < 2 || argc > MAX_ARGS) return 0;
+    out[0] = op;
+    out[1] = seq;
+    size_t n = 2;
+    for (uint8_t i = 0; i < argc; i++) {
+        size_t w = putVarint(out + n, cap - n, zigzag(args[i]));
+        if (!w) return 0;
+        n += w;
+    }
+    return n;
+}
+
+size_t encodeText(uint8_t* out, size_t cap, uint8_t seq, const char* s, size_t n) {
+    if (cap < 2) return 0;
+    if (n > cap - 2) n = cap - 2;
+    out[0] = OP_TEXT;
+    out[1] = seq;
+    memcpy(out + 2, s, n);
+    return n + 2;
+}
+
+bool decode(const uint8_t* in, size_t n, Frame& out) {
+    if (n < 2) return false;
+    out.op = in[0];
+    out.seq = in[1];
+    out.argc = 0;
+    out.text = nullptr;
+    out.textLen = 0;
+
+    if (out.op == OP_TEXT) {
+        out.text = in + 2;
+        out.textLen = n - 2;
+        return true;
+    }
+
+    size_t i = 2;
+    while (i < n) {
+        if (out.argc >= MAX_ARGS) return false;
+        uint32_t v;
+        size_t r = getVarint(in + i, n - i, &v);
+        if (!r) return false;
+        out.args[out.argc++] = unzigzag(v);
+        i += r;
+    }
+    return true;
+}
+
+}
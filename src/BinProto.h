@@ -0,0 +1,53 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary event framing, one frame per notification:
+//   [op] [seq] [arg varint]...       args are zigzag LEB128, any count
+//   [OP_TEXT] [seq] [utf-8 bytes]    text that has no opcode of its own
+// seq counts frames per connection and wraps at 256, so the phone can spot
+// gaps. With an MTU above 23 one notification carries several frames, each
+// prefixed by a length byte, OP_TEXT frames included; a frame too long for
+// that goes out alone, unprefixed, as every frame does at MTU 23.
+// Plain C++, shared with the host-side decoder.
+namespace BinProto {
+    static constexpr uint8_t VERSION = 1;
+
+    enum Op : uint8_t {
+        OP_BTN_CLICK  = 0x01,   // idx
+        OP_BTN_LONG   = 0x02,   // idx
+        OP_BTN_DOUBLE = 0x03,   // idx
+        OP_ENC_KEY    = 0x04,   // enc, long
+        OP_ENC_DELTA  = 0x05,   // enc, delta
+        OP_TOUCH_DOWN = 0x06,   // x, y
+        OP_TOUCH_UP   = 0x07,
+        OP_TOUCH_XY   = 0x08,   // x, y
+        OP_GESTURE    = 0x09,   // kind, a, b
+        OP_TEXT       = 0x7F,
+    };
+
+    static constexpr uint8_t MAX_ARGS = 6;
+    static constexpr size_t  VARINT_MAX = 5;
+    static constexpr size_t  MAX_FRAME = 2 + MAX_ARGS * VARINT_MAX;
+
+    struct Frame {
+        uint8_t op;
+        uint8_t seq;
+        uint8_t argc;
+        int32_t args[MAX_ARGS];
+        const uint8_t* text;    // OP_TEXT only, points into the input
+        size_t textLen;
+    };
+
+    inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+    inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+    // Bytes written / consumed, 0 when out of room or malformed
+    size_t putVarint(uint8_t* out, size_t cap, uint32_t v);
+    size_t getVarint(const uint8_t* in, size_t n, uint32_t* v);
+
+    size_t encode(uint8_t* out, size_t cap, uint8_t op, uint8_t seq, const int32_t* args, uint8_t argc);
+    size_t encodeText(uint8_t* out, size_t cap, uint8_t seq, const char* s, size_t n);
+
+    bool decode(const uint8_t* in, size_t n, Frame& out);
+}
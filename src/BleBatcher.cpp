@@ -0,0 +1,75 @@
+#include "BleBatcher.h"
+
+void BleBatcher::setMtu(uint16_t mtu) {
+    if (mtu < DEFAULT_MTU) mtu = DEFAULT_MTU;
+    if (mtu > MAX_PAYLOAD + 3) mtu = MAX_PAYLOAD + 3;
+    if (mtu == mtu_) return;
+
+    flush();
+    mtu_ = mtu;
+}
+
+void BleBatcher::setFraming(Framing f) {
+    if (f == framing_) return;
+    flush();
+    framing_ = f;
+}
+
+void BleBatcher::sendBuf(const uint8_t* data, size_t n, uint16_t records) {
+    if (!send_(data, n)) stats_.sendErrors++;
+    stats_.notifies++;
+    stats_.records += records;
+    stats_.bytes += n;
+}
+
+void BleBatcher::add(const uint8_t* rec, size_t n, uint32_t nowUs) {
+    if (!batching()) {
+        sendBuf(rec, n, 1);
+        return;
+    }
+
+    // a record too long to frame goes out alone and unframed, as it would at
+    // the default MTU; only what exceeds a whole notification is cut
+    bool frameable = n + 1 <= payload() && !(framing_ == Framing::LengthPrefix && n > 255);
+    if (!frameable) {
+        flush();
+        stats_.unframed++;
+        if (n > payload()) {
+            n = payload();
+            stats_.truncated++;
+        }
+        sendBuf(rec, n, 1);
+        return;
+    }
+
+    if (len_ + n + 1 > payload()) flush();
+    if (len_ == 0) firstUs_ = nowUs;
+
+    if (framing_ == Framing::LengthPrefix) {
+        buf_[len_++] = (uint8_t)n;
+        memcpy(buf_ + len_, rec, n);
+        len_ += n;
+    } else {
+        memcpy(buf_ + len_, rec, n);
+        len_ += n;
+        buf_[len_++] = '\n';
+    }
+    count_++;
+}
+
+void BleBatcher::poll(uint32_t nowUs) {
+    if (len_ && (nowUs - firstUs_) >= flushUs_) flush();
+}
+
+void BleBatcher::flush() {
+    if (!len_) return;
+    sendBuf(buf_, len_, count_);
+    len_ = 0;
+    count_ = 0;
+}
+
+uint32_t BleBatcher::untilDueUs(uint32_t nowUs) const {
+    if (!len_) return UINT32_MAX;
+    uint32_t age = nowUs - firstUs_;
+    return (age >= flushUs_) ? 0 : flushUs_ - age;
+}
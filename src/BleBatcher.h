@@ -0,0 +1,64 @@
+#pragma once
+#include <Arduino.h>
+
+// Packs outgoing records into one notification of up to MTU-3 bytes and
+// sends it when the next record won't fit or the flush deadline passes.
+// At the default 23-byte MTU every record goes out alone and unframed,
+// exactly as before batching; so does a record that doesn't fit a frame.
+class BleBatcher {
+public:
+    enum class Framing : uint8_t { Newline, LengthPrefix };
+
+    static constexpr uint16_t DEFAULT_MTU = 23;
+    static constexpr size_t   MAX_PAYLOAD = 512;
+
+    using SendFn = bool (*)(const uint8_t* data, size_t n);
+
+    struct Stats {
+        uint32_t notifies;
+        uint32_t records;
+        uint32_t bytes;
+        uint32_t sendErrors;   // SendFn returned false
+        uint32_t unframed;     // too long for a frame, sent in a notification of its own
+        uint32_t truncated;    // longer than a whole notification, tail cut
+    };
+
+    explicit BleBatcher(SendFn send) : send_(send) {}
+
+    void setMtu(uint16_t mtu);
+    uint16_t mtu() const { return mtu_; }
+    bool batching() const { return mtu_ > DEFAULT_MTU; }
+
+    void setFlushUs(uint32_t us) { flushUs_ = us; }
+    void setFraming(Framing f);
+
+    void add(const uint8_t* rec, size_t n, uint32_t nowUs);
+
+    // Flushes once the oldest pending record is flushUs old
+    void poll(uint32_t nowUs);
+    void flush();
+
+    // Drops whatever is pending (link gone)
+    void reset() { len_ = 0; }
+
+    bool pending() const { return len_ > 0; }
+    uint32_t untilDueUs(uint32_t nowUs) const;
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    size_t payload() const { return (size_t)mtu_ - 3; }
+    void sendBuf(const uint8_t* data, size_t n, uint16_t records);
+
+    SendFn send_;
+    uint16_t mtu_ = DEFAULT_MTU;
+    uint32_t flushUs_ = 10000;
+    Framing framing_ = Framing::Newline;
+
+    uint8_t buf_[MAX_PAYLOAD];
+    size_t len_ = 0;
+    uint16_t count_ = 0;
+    uint32_t firstUs_ = 0;
+
+    Stats stats_ = {};
+};
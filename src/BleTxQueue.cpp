@@ -0,0 +1,48 @@
+#include "BleTxQueue.h"
+
+bool BleTxQueue::push(Class c, uint8_t framing, const uint8_t* data, size_t n) {
+    if (n > MAX_REC) {
+        stats_.dropped[c]++;
+        return false;
+    }
+
+    Record r;
+    r.len = (uint8_t)n;
+    r.framing = framing;
+    memcpy(r.data, data, n);
+
+    uint32_t size;
+    if (c == Control) {
+        if (!control_.push(r)) {
+            stats_.refused++;
+            return false;
+        }
+        size = control_.size();
+    } else {
+        if (telemetry_.full()) {
+            Record old;
+            telemetry_.pop(old);
+            stats_.dropped[Telemetry]++;
+        }
+        telemetry_.push(r);
+        size = telemetry_.size();
+    }
+
+    stats_.queued[c]++;
+    if (size > stats_.highWater[c]) stats_.highWater[c] = size;
+    return true;
+}
+
+bool BleTxQueue::room(Class c) const {
+    return (c == Control) ? !control_.full() : true;
+}
+
+bool BleTxQueue::pop(Record& out) {
+    return control_.pop(out) || telemetry_.pop(out);
+}
+
+void BleTxQueue::clear() {
+    Record r;
+    while (control_.pop(r)) stats_.discarded[Control]++;
+    while (telemetry_.pop(r)) stats_.discarded[Telemetry]++;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+
+#include "AppConfig.h"
+#include "SpscRing.h"
+
+// Encoded BLE records waiting for link credits, in two classes. Control is
+// never dropped: when full, push() refuses and the producer must hold on
+// to the event (room() is the backpressure signal). Telemetry evicts its
+// oldest record instead. Producer and consumer are both loop().
+class BleTxQueue {
+public:
+    enum Class : uint8_t { Control, Telemetry, CLASSES };
+
+    static constexpr uint8_t MAX_REC = LogCfg::LEN + 2;
+
+    struct Record {
+        uint8_t len;
+        uint8_t framing;    // BleBatcher::Framing the record was encoded for
+        uint8_t data[MAX_REC];
+    };
+
+    struct Stats {
+        uint32_t queued[CLASSES];
+        uint32_t dropped[CLASSES];     // telemetry evicted / oversized
+        uint32_t refused;              // control push while full
+        uint32_t discarded[CLASSES];   // cleared on disconnect
+        uint32_t highWater[CLASSES];
+    };
+
+    bool push(Class c, uint8_t framing, const uint8_t* data, size_t n);
+    bool room(Class c) const;
+
+    // Control first
+    bool pop(Record& out);
+
+    bool empty() const { return control_.empty() && telemetry_.empty(); }
+
+    // Drops everything, counted per class
+    void clear();
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    SpscRing<Record, BleTxCfg::CONTROL_SLOTS> control_;
+    SpscRing<Record, BleTxCfg::TELEMETRY_SLOTS> telemetry_;
+    Stats stats_ = {};
+};
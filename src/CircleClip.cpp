@@ -0,0 +1,57 @@
+#include "CircleClip.h"
+
+ClipStats CircleClip::fillRows(Adafruit_GFX& gfx, const CircleGeometry& geom,
+                               int16_t y0, int16_t y1, int16_t xMin, int16_t xMax,
+                               uint16_t color) {
+    ClipStats st = {0, 0};
+
+    // pending rectangle
+    int16_t ry = 0, rl = 0, rr = -1, rows = 0;
+    int32_t used = 0;  // pixels actually inside the circle
+
+    auto flush = [&]() {
+        if (rows == 0) return;
+        gfx.fillRect(rl, ry, rr - rl + 1, rows, color);
+        st.pixels += (uint32_t)(rr - rl + 1) * (uint32_t)rows;
+        st.windows++;
+        rows = 0;
+    };
+
+    for (int16_t y = y0; y <= y1; y++) {
+        int16_t l, r;
+        if (!geom.span(y, 0, &l, &r)) {
+            flush();
+            continue;
+        }
+        if (l < xMin) l = xMin;
+        if (r > xMax) r = xMax;
+        if (r < l) {
+            flush();
+            continue;
+        }
+
+        if (rows > 0) {
+            int16_t nl = (l < rl) ? l : rl;
+            int16_t nr = (r > rr) ? r : rr;
+            int32_t area = (int32_t)(nr - nl + 1) * (rows + 1);
+            int32_t waste = area - (used + (r - l + 1));
+            int32_t oldWaste = (int32_t)(rr - rl + 1) * rows - used;
+            if (waste - oldWaste <= WINDOW_COST_PX) {
+                rl = nl;
+                rr = nr;
+                rows++;
+                used += r - l + 1;
+                continue;
+            }
+            flush();
+        }
+
+        ry = y;
+        rl = l;
+        rr = r;
+        rows = 1;
+        used = r - l + 1;
+    }
+    flush();
+    return st;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+#include "CircleGeometry.h"
+
+struct ClipStats {
+    uint32_t pixels;
+    uint16_t windows;
+};
+
+namespace CircleClip {
+    // Extra pixels we'd rather overdraw (off-circle, invisible) than open
+    // another address window: CASET/RASET/RAMWR + CS toggling cost about this much.
+    static constexpr uint16_t WINDOW_COST_PX = 16;
+
+    // Fill rows [y0, y1] inside the circle, clipped to columns [xMin, xMax].
+    // Neighbouring rows are merged into one fillRect while the overdraw stays
+    // under WINDOW_COST_PX per saved window.
+    ClipStats fillRows(Adafruit_GFX& gfx, const CircleGeometry& geom,
+                       int16_t y0, int16_t y1, int16_t xMin, int16_t xMax,
+                       uint16_t color);
+}
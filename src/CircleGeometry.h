@@ -0,0 +1,75 @@
+#pragma once
+#include <stdint.h>
+
+// Chord half-widths of a circle for every row, rounded like
+// roundf(sqrtf(r*r - dy*dy)). Built once; constexpr for fixed circles so
+// the table lands in flash and lookups are plain integer reads.
+class CircleGeometry {
+public:
+    static constexpr int16_t MAX_R = 255;
+
+    constexpr CircleGeometry(int16_t cx, int16_t cy, int16_t r)
+        : cx_(cx), cy_(cy), r_(r < 0 ? 0 : (r > MAX_R ? MAX_R : r)) {
+        const uint32_t rr = (uint32_t)r_ * (uint32_t)r_;
+        for (int16_t d = 0; d < r_; d++) {
+            half_[d] = (uint8_t)roundSqrt(rr - (uint32_t)d * (uint32_t)d);
+        }
+    }
+
+    constexpr int16_t cx() const { return cx_; }
+    constexpr int16_t cy() const { return cy_; }
+    constexpr int16_t r() const { return r_; }
+
+    constexpr bool matches(int16_t cx, int16_t cy, int16_t r) const {
+        return cx_ == cx && cy_ == cy && r_ == r;
+    }
+
+    // Half-width of row y, -1 if the row misses the circle
+    constexpr int16_t halfWidth(int16_t y) const {
+        int16_t d = (y < cy_) ? (int16_t)(cy_ - y) : (int16_t)(y - cy_);
+        return (d < r_) ? (int16_t)half_[d] : (int16_t)-1;
+    }
+
+    // Visible span [xLeft, xRight] of row y shrunk by margin on both sides
+    constexpr bool span(int16_t y, int16_t margin, int16_t* xLeft, int16_t* xRight) const {
+        int16_t h = halfWidth(y);
+        if (h < 0) return false;
+
+        int16_t xl = cx_ - h + margin;
+        int16_t xr = cx_ + h - margin;
+        if (xr <= xl) return false;
+        *xLeft = xl;
+        *xRight = xr;
+        return true;
+    }
+
+    constexpr bool contains(int16_t x, int16_t y) const {
+        int16_t h = halfWidth(y);
+        return h >= 0 && x >= cx_ - h && x <= cx_ + h;
+    }
+
+private:
+    static constexpr uint32_t roundSqrt(uint32_t n) {
+        uint32_t x = 0;
+        uint32_t bit = 1u << 30;
+        while (bit > n) bit >>= 2;
+
+        uint32_t v = n;
+        while (bit) {
+            if (v >= x + bit) {
+                v -= x + bit;
+                x = (x >> 1) + bit;
+            } else {
+                x >>= 1;
+            }
+            bit >>= 2;
+        }
+        // sqrt(n) >= x + 0.5  <=>  n > x*x + x
+        return (n - x * x > x) ? x + 1 : x;
+    }
+
+    int16_t cx_;
+    int16_t cy_;
+    int16_t r_;
+    uint8_t half_[MAX_R] = {};
+};
@@ -1,93 +1,86 @@
 #include "CircleText.h"
-#include <cmath>
+#include "TextMetrics.h"
+#include <string.h>
 
 static CircleTextConfig g_cfg;
+static CircleText::Stats g_stats;
 
 void CircleText::setConfig(const CircleTextConfig& cfg) {
     g_cfg = cfg;
 }
 
-static void measureText(Adafruit_GFX& gfx, const char* s, int16_t* w, int16_t* h) {
-    int16_t x1, y1;
-    uint16_t ww, hh;
-    gfx.getTextBounds(s, 0, 0, &x1, &y1, &ww, &hh);
-    *w = (int16_t)ww;
-    *h = (int16_t)hh;
+const CircleText::Stats& CircleText::stats() {
+    return g_stats;
 }
 
-static int16_t textLineHeight(Adafruit_GFX& gfx) {
-    int16_t w, h;
-    measureText(gfx, "Ay", &w, &h);
-    return (h > 0) ? h : 8;
-}
-
-static size_t fitCharsIntoWidth(Adafruit_GFX& gfx, const char* s, int16_t maxW) {
-    char tmp[96];
-    size_t n = 0;
-    tmp[0] = '\0';
-
-    while (s[n] && n < sizeof(tmp) - 1) {
-        tmp[n] = s[n];
-        tmp[n + 1] = '\0';
+const CircleGeometry& CircleText::geometryFor(const CircleTextConfig& cfg) {
+    if (cfg.geometry && cfg.geometry->matches(cfg.cx, cfg.cy, cfg.r)) return *cfg.geometry;
 
-        int16_t w, h;
-        measureText(gfx, tmp, &w, &h);
-        if (w > maxW) return (n == 0) ? 1 : n;
-        n++;
-    }
-    return n;
+    static CircleGeometry fallback(cfg.cx, cfg.cy, cfg.r);
+    if (!fallback.matches(cfg.cx, cfg.cy, cfg.r)) fallback = CircleGeometry(cfg.cx, cfg.cy, cfg.r);
+    return fallback;
 }
 
-static bool circleLineBounds(int16_t cx, int16_t cy, int16_t R,
-                             int16_t y, int16_t margin,
-                             int16_t* xLeft, int16_t* xRight) {
-    int32_t dy = (int32_t)y - (int32_t)cy;
-    int32_t rr = (int32_t)R * (int32_t)R;
-    int32_t ddy = dy * dy;
-    if (ddy >= rr) return false;
-
-    float dx = sqrtf((float)(rr - ddy));
-    int16_t xl = (int16_t)roundf((float)cx - dx) + margin;
-    int16_t xr = (int16_t)roundf((float)cx + dx) - margin;
-
-    if (xr <= xl) return false;
-    *xLeft = xl;
-    *xRight = xr;
-    return true;
-}
-
-// Layout pass: calculate how many lines will be produced and total height
-static int16_t layoutHeight(Adafruit_GFX& gfx,
-                            const CircleTextConfig& cfg,
-                            const char* text) {
-    gfx.setTextSize(cfg.textSize);
-
-    int16_t lineH = textLineHeight(gfx);
-    int16_t cursorY = cfg.topY;
-
-    String line;
-    line.reserve(160);
-
-    auto flushLine = [&](int16_t xLeft, int16_t maxW) -> bool {
-        if (line.length() == 0) return true;
-
-        int16_t lw, lh;
-        measureText(gfx, line.c_str(), &lw, &lh);
+// ===================== Layout =====================
+// Single word-wrapping pass starting at startY. Widths are running sums of
+// glyph advances; lines are slices of text, so drawing is just a replay.
+// False when rows or line slots ran out before the end of the text.
+static bool layoutLines(const TextMetrics& tm,
+                        const CircleGeometry& geom,
+                        const CircleTextConfig& cfg,
+                        const char* text,
+                        int16_t startY,
+                        CircleTextLayout& out) {
+    g_stats.layouts++;
+
+    const int16_t lineH = tm.lineHeight();
+    int16_t cursorY = startY;
+    out.count = 0;
+    out.height = 0;
+    out.box = CircleTextBox();
+
+    const char* lineStart = nullptr;
+    const char* lineEnd = nullptr;
+    TextMetrics::Run lineRun;
+
+    auto flushLine = [&](int16_t xLeft, int16_t width) -> bool {
+        if (!lineStart) return true;
+        if (cursorY + lineH > cfg.bottomY) return false;
+        if (out.count >= CircleText::MAX_LINES) return false;
+
+        size_t len = (size_t)(lineEnd - lineStart);
+        if (len > 255) len = 255;
+
+        CircleTextLine& l = out.lines[out.count++];
+        l.start = (uint16_t)(lineStart - text);
+        l.len = (uint8_t)len;
+        l.xLeft = xLeft;
+        l.y = cursorY;
+        l.width = width;
+
+        if (out.box.empty()) {
+            out.box = {xLeft, cursorY, (int16_t)(xLeft + width - 1), (int16_t)(cursorY + lineH - 1)};
+        } else {
+            if (xLeft < out.box.x0) out.box.x0 = xLeft;
+            if (xLeft + width - 1 > out.box.x1) out.box.x1 = xLeft + width - 1;
+            out.box.y1 = cursorY + lineH - 1;
+        }
 
-        cursorY += lh + cfg.lineGap;
-        line = "";
-        return cursorY <= cfg.bottomY;
+        cursorY += lineH + cfg.lineGap;
+        lineStart = lineEnd = nullptr;
+        return true;
     };
 
     const char* p = text;
+    bool stopped = false;
 
-    while (*p) {
+    while (*p && !stopped) {
         while (*p == ' ') p++;
 
+        int16_t xL, xR;
         if (*p == '\n') {
-            int16_t xL, xR;
-            if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) break;
-            flushLine(xL, xR - xL);
+            if (!geom.span(cursorY, cfg.margin, &xL, &xR)) { stopped = true; break; }
+            if (!flushLine(xL, lineRun.width())) { stopped = true; break; }
             cursorY += cfg.lineGap;
             p++;
             continue;
@@ -95,196 +88,181 @@ static int16_t layoutHeight(Adafruit_GFX& gfx,
 
         if (!*p) break;
 
-        int16_t xL, xR;
-        if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) break;
+        if (!geom.span(cursorY, cfg.margin, &xL, &xR)) { stopped = true; break; }
         int16_t maxW = xR - xL;
 
         const char* start = p;
         while (*p && *p != ' ' && *p != '\n') p++;
-        size_t len = (size_t)(p - start);
-        if (len == 0) continue;
-
-        String word;
-        word.reserve(len + 1);
-        for (size_t i = 0; i < len; i++) word += start[i];
-
-        String candidate = line;
-        if (candidate.length() > 0) candidate += " ";
-        candidate += word;
 
-        int16_t candW, candH;
-        measureText(gfx, candidate.c_str(), &candW, &candH);
+        // candidate = current line extended up to the end of this word
+        TextMetrics::Run cand = lineStart ? lineRun : TextMetrics::Run();
+        const char* from = lineStart ? lineEnd : start;
+        for (const char* q = from; q < p; q++) tm.push(cand, *q);
+        g_stats.measuredGlyphs += (uint32_t)(p - from);
 
-        if (candW <= maxW) {
-            line = candidate;
+        if (cand.width() <= maxW) {
+            if (!lineStart) lineStart = start;
+            lineEnd = p;
+            lineRun = cand;
             continue;
         }
 
-        if (line.length() > 0) {
-            if (!flushLine(xL, maxW)) break;
-            if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) break;
+        if (lineStart) {
+            if (!flushLine(xL, lineRun.width())) { stopped = true; break; }
+            if (!geom.span(cursorY, cfg.margin, &xL, &xR)) { stopped = true; break; }
             maxW = xR - xL;
         }
 
-        int16_t wordW, wordH;
-        measureText(gfx, word.c_str(), &wordW, &wordH);
+        TextMetrics::Run word;
+        for (const char* q = start; q < p; q++) tm.push(word, *q);
+        g_stats.measuredGlyphs += (uint32_t)(p - start);
 
-        if (wordW <= maxW) {
-            line = word;
+        if (word.width() <= maxW) {
+            lineStart = start;
+            lineEnd = p;
+            lineRun = word;
             continue;
         }
 
-        const char* ws = word.c_str();
-        while (*ws) {
-            if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) break;
+        // word is wider than the row: hard-split it
+        const char* ws = start;
+        while (ws < p) {
+            if (!geom.span(cursorY, cfg.margin, &xL, &xR)) { stopped = true; break; }
             maxW = xR - xL;
 
-            size_t chunkLen = fitCharsIntoWidth(gfx, ws, maxW);
-            String chunk;
-            chunk.reserve(chunkLen + 1);
-            for (size_t i = 0; i < chunkLen; i++) chunk += ws[i];
-
-            line = chunk;
-            if (!flushLine(xL, maxW)) break;
+            size_t chunkLen = tm.fit(ws, (size_t)(p - ws), maxW);
+            g_stats.measuredGlyphs += (uint32_t)chunkLen;
+            lineStart = ws;
+            lineEnd = ws + chunkLen;
+            if (!flushLine(xL, tm.width(ws, chunkLen))) { stopped = true; break; }
             ws += chunkLen;
         }
     }
 
-    // flush last line
-    if (line.length() > 0) {
+    bool whole = !stopped;
+    if (whole && lineStart) {
         int16_t xL, xR;
-        if (circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) {
-            int16_t lw, lh;
-            measureText(gfx, line.c_str(), &lw, &lh);
-            cursorY += lh;
-        }
+        whole = geom.span(cursorY, cfg.margin, &xL, &xR) && flushLine(xL, lineRun.width());
     }
 
-    int16_t used = cursorY - cfg.topY;
-    if (used < 0) used = 0;
-    return used;
+    if (out.count > 0) {
+        out.height = out.lines[out.count - 1].y + lineH - startY;
+    }
+    return whole;
 }
 
-static void drawWrappedTextCircle(Adafruit_GFX& gfx,
-                                  CircleTextConfig cfg,
-                                  const char* text,
-                                  CircleTextPos pos) {
-    gfx.setTextSize(cfg.textSize);
-    gfx.setTextColor(cfg.color);
-
-    // compute Y start based on pos
-    int16_t h = layoutHeight(gfx, cfg, text);
-
-    int16_t available = cfg.bottomY - cfg.topY;
-    if (available < 0) available = 0;
-
-    int16_t startY = cfg.topY;
-    if (pos == CircleTextPos::Center) {
-        startY = cfg.topY + (available - h) / 2;
-    } else if (pos == CircleTextPos::Bottom) {
-        startY = cfg.bottomY - h;
+// Breaks depend on rows only through their chord widths, so a layout whose
+// rows keep their widths when moved by dy can be moved instead of re-wrapped.
+static bool sameRowWidths(const CircleGeometry& geom, int16_t y0, int16_t h, int16_t dy) {
+    for (int16_t y = y0; y < y0 + h; y++) {
+        if (geom.halfWidth(y) != geom.halfWidth(y + dy)) return false;
     }
-    if (startY < cfg.topY) startY = cfg.topY;
-
-    int16_t cursorY = startY;
-
-    String line;
-    line.reserve(160);
-
-    auto flushLine = [&](int16_t xLeft, int16_t maxW) -> bool {
-        if (line.length() == 0) return true;
-
-        int16_t lw, lh;
-        measureText(gfx, line.c_str(), &lw, &lh);
-        if (cursorY + lh > cfg.bottomY) return false;
-
-        gfx.setCursor(xLeft, cursorY);
-        gfx.print(line);
-
-        cursorY += lh + cfg.lineGap;
-        line = "";
-        return true;
-    };
+    return true;
+}
 
-    const char* p = text;
+static void shiftLayout(CircleTextLayout& out, int16_t dy) {
+    for (uint8_t i = 0; i < out.count; i++) out.lines[i].y += dy;
+    if (!out.box.empty()) {
+        out.box.y0 += dy;
+        out.box.y1 += dy;
+    }
+}
 
+// ===================== Layout cache =====================
+struct CacheSlot {
+    bool used;
+    uint32_t hash;
+    uint16_t textLen;
+    char text[CircleText::CACHE_TEXT];  // a hash match alone may be a collision
+    CircleTextConfig cfg;
+    CircleTextPos pos;
+    uint32_t lastUse;
+    CircleTextLayout table;
+};
+
+static CacheSlot g_cache[CircleText::CACHE_SLOTS];
+static CircleTextLayout g_uncached;
+static uint32_t g_cacheClock = 0;
+
+// FNV-1a
+static uint32_t hashText(const char* s, uint16_t* len) {
+    uint32_t h = 2166136261u;
+    const char* p = s;
     while (*p) {
-        while (*p == ' ') p++;
-
-        if (*p == '\n') {
-            int16_t xL, xR;
-            if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
-            if (!flushLine(xL, xR - xL)) return;
-            cursorY += cfg.lineGap;
-            p++;
-            continue;
-        }
-
-        if (!*p) break;
-
-        int16_t xL, xR;
-        if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
-        int16_t maxW = xR - xL;
-
-        const char* start = p;
-        while (*p && *p != ' ' && *p != '\n') p++;
-        size_t len = (size_t)(p - start);
-        if (len == 0) continue;
-
-        String word;
-        word.reserve(len + 1);
-        for (size_t i = 0; i < len; i++) word += start[i];
-
-        String candidate = line;
-        if (candidate.length() > 0) candidate += " ";
-        candidate += word;
-
-        int16_t candW, candH;
-        measureText(gfx, candidate.c_str(), &candW, &candH);
+        h ^= (uint8_t)*p++;
+        h *= 16777619u;
+    }
+    *len = (uint16_t)(p - s);
+    return h;
+}
 
-        if (candW <= maxW) {
-            line = candidate;
-            continue;
-        }
+static bool sameConfig(const CircleTextConfig& a, const CircleTextConfig& b) {
+    return a.cx == b.cx && a.cy == b.cy && a.r == b.r &&
+           a.topY == b.topY && a.bottomY == b.bottomY &&
+           a.margin == b.margin && a.lineGap == b.lineGap &&
+           a.textSize == b.textSize && a.font == b.font;
+}
 
-        if (line.length() > 0) {
-            if (!flushLine(xL, maxW)) return;
+const CircleTextLayout& CircleText::layoutCached(const CircleTextConfig& cfg,
+                                                 const char* text,
+                                                 CircleTextPos pos) {
+    g_stats.draws++;
+    uint16_t len;
+    uint32_t h = hashText(text, &len);
+    g_cacheClock++;
+
+    if (len >= CACHE_TEXT) {
+        g_stats.uncached++;
+        CircleText::layout(cfg, text, pos, g_uncached);
+        return g_uncached;
+    }
 
-            if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
-            maxW = xR - xL;
+    CacheSlot* victim = &g_cache[0];
+    for (CacheSlot& s : g_cache) {
+        if (s.used && s.hash == h && s.textLen == len &&
+            s.pos == pos && sameConfig(s.cfg, cfg) && memcmp(s.text, text, len) == 0) {
+            s.lastUse = g_cacheClock;
+            g_stats.cacheHits++;
+            return s.table;
         }
+        if (!s.used || (victim->used && s.lastUse < victim->lastUse)) victim = &s;
+    }
 
-        int16_t wordW, wordH;
-        measureText(gfx, word.c_str(), &wordW, &wordH);
+    CircleText::layout(cfg, text, pos, victim->table);
 
-        if (wordW <= maxW) {
-            line = word;
-            continue;
-        }
+    victim->used = true;
+    victim->hash = h;
+    victim->textLen = len;
+    memcpy(victim->text, text, len);
+    victim->cfg = cfg;
+    victim->pos = pos;
+    victim->lastUse = g_cacheClock;
+    return victim->table;
+}
 
-        const char* ws = word.c_str();
-        while (*ws) {
-            if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
-            maxW = xR - xL;
+void CircleText::layout(const CircleTextConfig& cfg, const char* text, CircleTextPos pos, CircleTextLayout& out) {
+    TextMetrics tm(cfg.font, cfg.textSize);
+    const CircleGeometry& geom = CircleText::geometryFor(cfg);
+    bool whole = layoutLines(tm, geom, cfg, text, cfg.topY, out);
+    if (pos == CircleTextPos::Top) return;
 
-            size_t chunkLen = fitCharsIntoWidth(gfx, ws, maxW);
-            String chunk;
-            chunk.reserve(chunkLen + 1);
-            for (size_t i = 0; i < chunkLen; i++) chunk += ws[i];
+    int16_t available = cfg.bottomY - cfg.topY;
+    if (available < 0) available = 0;
 
-            line = chunk;
-            if (!flushLine(xL, maxW)) return;
-            ws += chunkLen;
-        }
+    int16_t startY = cfg.topY;
+    if (pos == CircleTextPos::Center) {
+        startY = cfg.topY + (available - out.height) / 2;
+    } else {
+        startY = cfg.bottomY - out.height;
     }
+    if (startY < cfg.topY) startY = cfg.topY;
 
-    if (line.length() > 0) {
-        int16_t xL, xR;
-        if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
-        flushLine(xL, xR - xL);
+    int16_t dy = startY - cfg.topY;
+    if (dy == 0) return;
+    if (whole && sameRowWidths(geom, cfg.topY, out.height, dy)) {
+        shiftLayout(out, dy);
+        g_stats.shifted++;
+        return;
     }
+    layoutLines(tm, geom, cfg, text, startY, out);
 }
-
-void CircleText::drawWithConfig(Adafruit_GFX& gfx, const CircleTextConfig& cfg, const char* text, CircleTextPos pos) {
-    drawWrappedTextCircle(gfx, cfg, text, pos);
-}
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
-#include <Arduino.h>
-#include <Adafruit_GFX.h>
+#include <stdint.h>
+#include <gfxfont.h>
+
+#include "CircleGeometry.h"
+
+class Adafruit_GFX;
 
 enum class CircleTextPos {
     Top,
@@ -22,10 +26,81 @@ struct CircleTextConfig {
 
     uint8_t textSize = 2;
     uint16_t color   = 0xFFFF;
+
+    const GFXfont* font = nullptr;  // nullptr = built-in 5x7
+
+    // Precomputed chords for cx/cy/r; built at runtime when missing
+    const CircleGeometry* geometry = nullptr;
+};
+
+// One laid out line: a slice of the source text and where it goes on screen
+struct CircleTextLine {
+    uint16_t start;
+    uint8_t  len;
+    int16_t  xLeft;
+    int16_t  y;
+    int16_t  width;
 };
 
 namespace CircleText {
+    static constexpr uint8_t MAX_LINES   = 12;
+    static constexpr uint8_t CACHE_SLOTS = 8;
+    static constexpr uint8_t CACHE_TEXT  = 48;  // longer texts are laid out every time
+}
+
+// Screen area covered by drawn text, inclusive; empty when x1 < x0
+struct CircleTextBox {
+    int16_t x0 = 0;
+    int16_t y0 = 0;
+    int16_t x1 = -1;
+    int16_t y1 = -1;
+
+    bool empty() const { return x1 < x0 || y1 < y0; }
+
+    void merge(const CircleTextBox& o) {
+        if (o.empty()) return;
+        if (empty()) { *this = o; return; }
+        if (o.x0 < x0) x0 = o.x0;
+        if (o.y0 < y0) y0 = o.y0;
+        if (o.x1 > x1) x1 = o.x1;
+        if (o.y1 > y1) y1 = o.y1;
+    }
+};
+
+// Caller-owned line table; valid only together with the text it was built from
+struct CircleTextLayout {
+    CircleTextLine lines[CircleText::MAX_LINES];
+    uint8_t count;
+    int16_t height;
+    CircleTextBox box;
+};
+
+namespace CircleText {
+    struct Stats {
+        uint32_t draws;         // cached layouts handed out
+        uint32_t layouts;       // full layout passes (cache misses)
+        uint32_t cacheHits;
+        uint32_t uncached;      // text too long to keep a copy of
+        uint32_t shifted;       // Center/Bottom moved without a second pass
+        uint32_t measuredGlyphs;
+    };
+
     void setConfig(const CircleTextConfig& cfg);
 
-    void drawWithConfig(Adafruit_GFX& gfx, const CircleTextConfig& cfg, const char* text, CircleTextPos pos = CircleTextPos::Top);
-}
\ No newline at end of file
+    // cfg.geometry when set and matching cx/cy/r, else a table built on demand
+    const CircleGeometry& geometryFor(const CircleTextConfig& cfg);
+
+    // Draws through the internal layout cache. No heap allocations.
+    // Returns the area touched so the caller can clear just that next time.
+    CircleTextBox drawWithConfig(Adafruit_GFX& gfx, const CircleTextConfig& cfg, const char* text, CircleTextPos pos = CircleTextPos::Top);
+
+    // Layout through the internal cache; the table lives in a cache slot,
+    // so use it before the next call
+    const CircleTextLayout& layoutCached(const CircleTextConfig& cfg, const char* text, CircleTextPos pos);
+
+    // Uncached variants working on caller storage
+    void layout(const CircleTextConfig& cfg, const char* text, CircleTextPos pos, CircleTextLayout& out);
+    CircleTextBox draw(Adafruit_GFX& gfx, const CircleTextConfig& cfg, const char* text, const CircleTextLayout& layout);
+
+    const Stats& stats();
+}
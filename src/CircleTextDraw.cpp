@@ -0,0 +1,23 @@
+#include "CircleText.h"
+#include "TextMetrics.h"
+#include <Adafruit_GFX.h>
+
+CircleTextBox CircleText::draw(Adafruit_GFX& gfx, const CircleTextConfig& cfg, const char* text, const CircleTextLayout& layout) {
+    gfx.setFont(cfg.font);
+    gfx.setTextSize(cfg.textSize);
+    gfx.setTextColor(cfg.color);
+
+    // rows are laid out by their top; a GFXfont prints from its baseline
+    const int16_t ascent = TextMetrics(cfg.font, cfg.textSize).ascent();
+
+    for (uint8_t i = 0; i < layout.count; i++) {
+        const CircleTextLine& l = layout.lines[i];
+        gfx.setCursor(l.xLeft, l.y + ascent);
+        gfx.write((const uint8_t*)text + l.start, l.len);
+    }
+    return layout.box;
+}
+
+CircleTextBox CircleText::drawWithConfig(Adafruit_GFX& gfx, const CircleTextConfig& cfg, const char* text, CircleTextPos pos) {
+    return draw(gfx, cfg, text, layoutCached(cfg, text, pos));
+}
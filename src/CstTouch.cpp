@@ -0,0 +1,60 @@
+#include "CstTouch.h"
+
+static TwoWire* g_wire = nullptr;
+static bool g_polled = false;
+static volatile bool g_pending = false;
+static volatile uint32_t g_irqs = 0;
+static CstTouch::Stats g_stats;
+static void (*g_onIrq)() = nullptr;
+
+static void IRAM_ATTR onTouchInt() {
+    g_pending = true;
+    g_irqs = g_irqs + 1;
+    if (g_onIrq) g_onIrq();
+}
+
+namespace CstTouch {
+
+void begin(TwoWire& wire, int intPin, bool polled, void (*onIrq)()) {
+    g_wire = &wire;
+    g_onIrq = onIrq;
+    g_polled = polled;
+    if (polled) return;
+
+    // replaces the library's handler on the same pin
+    pinMode(intPin, INPUT);
+    attachInterrupt(digitalPinToInterrupt(intPin), onTouchInt, RISING);
+}
+
+bool read(TouchPoint& out) {
+    if (!g_wire) return false;
+    if (!g_polled) {
+        if (!g_pending) return false;
+        g_pending = false;
+    }
+
+    // gesture, points, event|xH, xL, event-id|yH, yL from register 0x01
+    uint8_t b[6];
+    g_stats.reads++;
+    g_wire->beginTransmission(ADDR);
+    g_wire->write((uint8_t)0x01);
+    if (g_wire->endTransmission(false) != 0 || g_wire->requestFrom(ADDR, (uint8_t)sizeof(b)) != sizeof(b)) {
+        g_stats.readErrors++;
+        return false;
+    }
+    for (uint8_t i = 0; i < sizeof(b); i++) b[i] = (uint8_t)g_wire->read();
+
+    out.gesture = b[0];
+    out.points = b[1];
+    out.event = b[2] >> 6;
+    out.x = (int16_t)(((b[2] & 0x0F) << 8) | b[3]);
+    out.y = (int16_t)(((b[4] & 0x0F) << 8) | b[5]);
+    return true;
+}
+
+const Stats& stats() {
+    g_stats.irqs = g_irqs;
+    return g_stats;
+}
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+
+struct TouchPoint {
+    uint8_t gesture;
+    uint8_t points;
+    uint8_t event;   // 0 down, 1 up, 2 contact
+    int16_t x;
+    int16_t y;
+};
+
+// CST816S touch report read only after the INT line fired, so an idle panel
+// costs no I2C traffic. Controller init stays with the CST816S library.
+namespace CstTouch {
+    static constexpr uint8_t ADDR = 0x15;
+
+    struct Stats {
+        uint32_t irqs;
+        uint32_t reads;       // I2C transactions
+        uint32_t readErrors;
+    };
+
+    // polled = true reads every call, as the baseline to compare against.
+    // onIrq runs inside the ISR and must be IRAM_ATTR.
+    void begin(TwoWire& wire, int intPin, bool polled, void (*onIrq)() = nullptr);
+
+    // true when a fresh report was read into out
+    bool read(TouchPoint& out);
+
+    const Stats& stats();
+}
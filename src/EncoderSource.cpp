@@ -0,0 +1,67 @@
+#include "EncoderSource.h"
+
+// ===================== PCNT =====================
+static pcnt_count_mode_t countMode(QuadDecode::Action a) {
+    return (a == QuadDecode::INC) ? PCNT_COUNT_INC : PCNT_COUNT_DEC;
+}
+
+bool PcntEncoder::begin() {
+    pinMode(pinA_, INPUT_PULLUP);
+    pinMode(pinB_, INPUT_PULLUP);
+
+    // channel 0 counts A edges, channel 1 counts B edges; the other pin's
+    // level picks the direction -> every edge of both signals counts.
+    // Low control pin reverses, as QuadDecode::count() assumes.
+    pcnt_config_t c = {};
+    c.unit = unit_;
+    c.counter_h_lim = LIMIT;
+    c.counter_l_lim = -LIMIT;
+
+    c.channel = PCNT_CHANNEL_0;
+    c.pulse_gpio_num = pinA_;
+    c.ctrl_gpio_num = pinB_;
+    c.pos_mode = countMode(QuadDecode::EDGES_A.pos);
+    c.neg_mode = countMode(QuadDecode::EDGES_A.neg);
+    c.lctrl_mode = PCNT_MODE_REVERSE;
+    c.hctrl_mode = PCNT_MODE_KEEP;
+    if (pcnt_unit_config(&c) != ESP_OK) return false;
+
+    c.channel = PCNT_CHANNEL_1;
+    c.pulse_gpio_num = pinB_;
+    c.ctrl_gpio_num = pinA_;
+    c.pos_mode = countMode(QuadDecode::EDGES_B.pos);
+    c.neg_mode = countMode(QuadDecode::EDGES_B.neg);
+    if (pcnt_unit_config(&c) != ESP_OK) return false;
+
+    if (filter_) {
+        pcnt_set_filter_value(unit_, filter_ > 1023 ? 1023 : filter_);
+        pcnt_filter_enable(unit_);
+    }
+
+    pcnt_counter_pause(unit_);
+    pcnt_counter_clear(unit_);
+    pcnt_counter_resume(unit_);
+    lastRaw_ = 0;
+    unwrap_.reset();
+    return true;
+}
+
+long PcntEncoder::read() {
+    int16_t raw = 0;
+    if (pcnt_get_counter_value(unit_, &raw) != ESP_OK) raw = lastRaw_;
+    lastRaw_ = raw;
+    return unwrap_.update(raw);
+}
+
+// ===================== Library fallback =====================
+bool LibEncoder::begin() {
+    pinMode(pinA_, INPUT_PULLUP);
+    pinMode(pinB_, INPUT_PULLUP);
+
+    enc_.begin();
+    enc_.setAcceleration(0);
+
+    attachInterrupt(digitalPinToInterrupt(pinA_), isr_, CHANGE);
+    attachInterrupt(digitalPinToInterrupt(pinB_), isr_, CHANGE);
+    return true;
+}
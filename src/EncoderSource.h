@@ -0,0 +1,57 @@
+#pragma once
+#include <Arduino.h>
+#include <AiEsp32RotaryEncoder.h>
+#include <driver/pcnt.h>
+
+#include "QuadDecode.h"
+
+// Detent position of one rotary encoder, whatever does the decoding
+class EncoderSource {
+public:
+    virtual ~EncoderSource() = default;
+
+    virtual bool begin() = 0;
+
+    // Detents since begin(); only differences between reads matter
+    virtual long read() = 0;
+};
+
+// x4 quadrature decoded by a PCNT unit with its glitch filter on; no
+// interrupts. Edge directions come from QuadDecode, so a knob turns the
+// same way as with LibEncoder. The 16-bit counter wraps at +-LIMIT and
+// read() unwraps it, so it only has to be polled more often than LIMIT/2.
+class PcntEncoder : public EncoderSource {
+public:
+    static constexpr int16_t LIMIT = 30000;
+
+    // filterApb: pulses shorter than this many APB cycles (80 MHz) are ignored, max 1023
+    PcntEncoder(pcnt_unit_t unit, int pinA, int pinB, uint8_t countsPerDetent, uint16_t filterApb)
+        : unit_(unit), pinA_(pinA), pinB_(pinB), filter_(filterApb),
+          unwrap_(LIMIT, countsPerDetent) {}
+
+    bool begin() override;
+    long read() override;
+
+private:
+    pcnt_unit_t unit_;
+    int pinA_, pinB_;
+    uint16_t filter_;
+
+    int16_t lastRaw_ = 0;
+    QuadDecode::Unwrap unwrap_;
+};
+
+// AiEsp32RotaryEncoder with CHANGE interrupts on both pins
+class LibEncoder : public EncoderSource {
+public:
+    LibEncoder(AiEsp32RotaryEncoder& enc, int pinA, int pinB, void (*isr)())
+        : enc_(enc), pinA_(pinA), pinB_(pinB), isr_(isr) {}
+
+    bool begin() override;
+    long read() override { return enc_.readEncoder(); }
+
+private:
+    AiEsp32RotaryEncoder& enc_;
+    int pinA_, pinB_;
+    void (*isr_)();
+};
@@ -0,0 +1,44 @@
+#include "FixedTextField.h"
+
+uint8_t FixedTextField::update(BandCanvas& band, Adafruit_SPITFT& tft, const char* text) {
+    char next[MAX_CHARS + 1];
+    uint8_t n = 0;
+    while (text[n] && n < MAX_CHARS) {
+        next[n] = text[n];
+        n++;
+    }
+    // a shorter text blanks the cells it no longer covers
+    uint8_t cells = (valid_ && len_ > n) ? len_ : n;
+    for (uint8_t i = n; i < cells; i++) next[i] = ' ';
+    next[cells] = '\0';
+
+    int16_t first = -1, last = -1;
+    for (uint8_t i = 0; i < cells; i++) {
+        if (!valid_ || i >= len_ || next[i] != shown_[i]) {
+            if (first < 0) first = i;
+            last = i;
+        }
+    }
+
+    memcpy(shown_, next, cells + 1);
+    len_ = cells;
+    valid_ = true;
+    if (first < 0) return 0;
+
+    const int16_t cw = cellW(), ch = cellH();
+    const int16_t wx = x_ + first * cw;
+    const int16_t ww = (last - first + 1) * cw;
+
+    if (band.setWindow(wx, y_, ww, ch)) {
+        band.fillScreen(bg_);
+        for (int16_t i = first; i <= last; i++) {
+            band.drawChar(x_ + i * cw, y_, (unsigned char)next[i], fg_, fg_, size_);
+        }
+        band.push(tft, wx, y_, ww, ch);
+    } else {
+        for (int16_t i = first; i <= last; i++) {
+            tft.drawChar(x_ + i * cw, y_, (unsigned char)next[i], fg_, bg_, size_);
+        }
+    }
+    return (uint8_t)(last - first + 1);
+}
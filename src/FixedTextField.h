@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+#include <Adafruit_SPITFT.h>
+
+#include "BandCanvas.h"
+
+// Fixed-width text field in the built-in 6x8 font. update() rewrites only
+// the run of cells whose character changed, rendered through the band
+// canvas and sent as one window.
+class FixedTextField {
+public:
+    static constexpr uint8_t MAX_CHARS = 16;
+
+    FixedTextField(int16_t x, int16_t y, uint8_t size, uint16_t fg, uint16_t bg)
+        : x_(x), y_(y), size_(size), fg_(fg), bg_(bg) {}
+
+    int16_t cellW() const { return 6 * size_; }
+    int16_t cellH() const { return 8 * size_; }
+
+    // Next update() redraws every cell
+    void invalidate() { valid_ = false; }
+
+    // Returns cells rewritten
+    uint8_t update(BandCanvas& band, Adafruit_SPITFT& tft, const char* text);
+
+private:
+    int16_t x_, y_;
+    uint8_t size_;
+    uint16_t fg_, bg_;
+
+    char shown_[MAX_CHARS + 1] = {0};
+    uint8_t len_ = 0;
+    bool valid_ = false;
+};
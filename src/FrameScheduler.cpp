@@ -0,0 +1,22 @@
+#include "FrameScheduler.h"
+
+uint32_t FrameScheduler::untilDueUs(uint32_t nowUs) const {
+    if (!started_) return 0;
+    uint32_t since = nowUs - lastStartUs_;
+    return (since >= periodUs_) ? 0 : periodUs_ - since;
+}
+
+void FrameScheduler::frameStart(uint32_t nowUs) {
+    if (pending_ > 1) stats_.skipped += pending_ - 1;
+    pending_ = 0;
+    lastStartUs_ = nowUs;
+    started_ = true;
+}
+
+void FrameScheduler::frameEnd(uint32_t nowUs) {
+    uint32_t us = nowUs - lastStartUs_;
+    stats_.frames++;
+    stats_.lastUs = us;
+    if (us > stats_.maxUs) stats_.maxUs = us;
+    stats_.avgUs = (stats_.frames == 1) ? us : stats_.avgUs - (stats_.avgUs >> 3) + (us >> 3);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+
+// Per-display redraw gate. Producers call invalidate(); the display draws
+// when something is pending and its frame period has passed, so a burst of
+// invalidations collapses into one frame.
+class FrameScheduler {
+public:
+    struct Stats {
+        uint32_t frames;
+        uint32_t skipped;    // invalidations folded into a later frame
+        uint32_t lastUs;
+        uint32_t maxUs;
+        uint32_t avgUs;      // EMA, 1/8 weight
+    };
+
+    explicit FrameScheduler(uint16_t maxFps)
+        : periodUs_(maxFps ? 1000000UL / maxFps : 0) {}
+
+    void invalidate() { pending_++; }
+    bool pending() const { return pending_ > 0; }
+
+    // 0 when a frame may start now
+    uint32_t untilDueUs(uint32_t nowUs) const;
+    bool due(uint32_t nowUs) const { return pending_ > 0 && untilDueUs(nowUs) == 0; }
+
+    void frameStart(uint32_t nowUs);
+    void frameEnd(uint32_t nowUs);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    uint32_t periodUs_;
+    uint32_t pending_ = 0;
+    uint32_t lastStartUs_ = 0;
+    bool started_ = false;
+    Stats stats_ = {0, 0, 0, 0, 0};
+};
@@ -0,0 +1,122 @@
+#include "Gesture.h"
+
+static inline int32_t iabs(int32_t v) { return v < 0 ? -v : v; }
+
+// atan2 in 1/65536 turns, screen coordinates (y down) so clockwise grows.
+// atan(z) ~ z*pi/4 + 0.273*z*(1-z) on [0,1]; error < 0.25 deg.
+uint16_t GestureRecognizer::angle(int32_t dx, int32_t dy) {
+    int32_t ax = iabs(dx), ay = iabs(dy);
+    if (ax == 0 && ay == 0) return 0;
+
+    bool swap = ay > ax;
+    int32_t z = swap ? (ax << 15) / ay : (ay << 15) / ax;   // Q15, 0..1
+    int32_t a = (z * 8192 + ((2847 * z) >> 15) * (32768 - z)) >> 15;
+
+    if (swap) a = 16384 - a;      // reflect around 45 deg
+    if (dx < 0) a = 32768 - a;
+    if (dy < 0) a = 65536 - a;
+    return (uint16_t)a;
+}
+
+const char* GestureRecognizer::name(uint8_t kind) {
+    switch (kind) {
+        case Gesture::Tap:        return "TAP";
+        case Gesture::LongPress:  return "LONG";
+        case Gesture::SwipeLeft:  return "SWIPE_L";
+        case Gesture::SwipeRight: return "SWIPE_R";
+        case Gesture::SwipeUp:    return "SWIPE_U";
+        case Gesture::SwipeDown:  return "SWIPE_D";
+        case Gesture::Rotate:     return "ROT";
+        default:                  return "NONE";
+    }
+}
+
+void GestureRecognizer::down(int16_t x, int16_t y, uint32_t tMs) {
+    active_ = true;
+    moved_ = false;
+    longFired_ = false;
+    x0_ = x_ = x;
+    y0_ = y_ = y;
+    t0_ = tMs;
+
+    haveAngle_ = false;
+    rot_ = 0;
+    minR2_ = UINT32_MAX;
+    maxR2_ = 0;
+    track(x, y);
+}
+
+void GestureRecognizer::move(int16_t x, int16_t y) {
+    if (!active_) return;
+    x_ = x;
+    y_ = y;
+    if (iabs(x - x0_) > cfg_.tapSlop || iabs(y - y0_) > cfg_.tapSlop) moved_ = true;
+    track(x, y);
+}
+
+void GestureRecognizer::track(int16_t x, int16_t y) {
+    int32_t dx = x - cfg_.cx, dy = y - cfg_.cy;
+    uint32_t r2 = (uint32_t)(dx * dx + dy * dy);
+
+    // too close to the centre for a stable angle: break the chain
+    if (r2 < (uint32_t)cfg_.rotMinR * cfg_.rotMinR) {
+        haveAngle_ = false;
+        return;
+    }
+
+    uint16_t a = angle(dx, dy);
+    if (haveAngle_) rot_ += (int16_t)(uint16_t)(a - lastAngle_);
+    lastAngle_ = a;
+    haveAngle_ = true;
+
+    if (r2 < minR2_) minR2_ = r2;
+    if (r2 > maxR2_) maxR2_ = r2;
+}
+
+Gesture GestureRecognizer::tick(uint32_t tMs) {
+    Gesture g;
+    if (!active_ || moved_ || longFired_) return g;
+    if (tMs - t0_ < cfg_.longMs) return g;
+
+    longFired_ = true;
+    g.kind = Gesture::LongPress;
+    g.a = x0_;
+    g.b = y0_;
+    return g;
+}
+
+Gesture GestureRecognizer::up(uint32_t tMs) {
+    Gesture g;
+    if (!active_) return g;
+    active_ = false;
+    if (longFired_) return g;
+
+    // rotation: enough angle and the radius stayed within the ring
+    int32_t deg = (rot_ * 360 + (rot_ >= 0 ? 32768 : -32768)) / 65536;
+    uint32_t pct = cfg_.rotRoundPct;
+    if (iabs(deg) >= cfg_.rotMinDeg && maxR2_ > 0 &&
+        (uint64_t)minR2_ * 10000 >= (uint64_t)maxR2_ * pct * pct) {
+        g.kind = Gesture::Rotate;
+        g.a = (int16_t)deg;
+        return g;
+    }
+
+    int32_t dx = x_ - x0_, dy = y_ - y0_;
+    if (iabs(dx) >= cfg_.swipeMin || iabs(dy) >= cfg_.swipeMin) {
+        if (iabs(dx) >= iabs(dy)) {
+            g.kind = (dx < 0) ? Gesture::SwipeLeft : Gesture::SwipeRight;
+            g.a = (int16_t)iabs(dx);
+        } else {
+            g.kind = (dy < 0) ? Gesture::SwipeUp : Gesture::SwipeDown;
+            g.a = (int16_t)iabs(dy);
+        }
+        return g;
+    }
+
+    if (moved_) return g;
+
+    g.kind = (tMs - t0_ >= cfg_.longMs) ? Gesture::LongPress : Gesture::Tap;
+    g.a = x0_;
+    g.b = y0_;
+    return g;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+
+struct GestureCfg {
+    int16_t  cx, cy;       // rotation centre
+    uint16_t tapSlop;      // px of travel that still counts as a tap / long press
+    uint16_t longMs;
+    uint16_t swipeMin;     // px along the dominant axis
+    uint16_t rotMinR;      // points closer to the centre don't count for rotation
+    uint16_t rotMinDeg;
+    uint8_t  rotRoundPct;  // min/max radius ratio that still counts as circular
+};
+
+struct Gesture {
+    enum Kind : uint8_t { None, Tap, LongPress, SwipeLeft, SwipeRight, SwipeUp, SwipeDown, Rotate };
+
+    uint8_t kind = None;
+    int16_t a = 0;   // Tap/LongPress: x, Swipe: distance px, Rotate: degrees, clockwise > 0
+    int16_t b = 0;   // Tap/LongPress: y
+};
+
+// Incremental recognizer fed with one touch stroke at a time. Integer math
+// only, constant state: angles are 16-bit binary (65536 per turn), so the
+// rotation sum is just wrapped differences.
+class GestureRecognizer {
+public:
+    explicit constexpr GestureRecognizer(const GestureCfg& cfg) : cfg_(cfg) {}
+
+    void down(int16_t x, int16_t y, uint32_t tMs);
+    void move(int16_t x, int16_t y);
+
+    // LongPress once the finger stayed put for longMs
+    Gesture tick(uint32_t tMs);
+
+    // Classifies the finished stroke
+    Gesture up(uint32_t tMs);
+
+    static uint16_t angle(int32_t dx, int32_t dy);
+    static const char* name(uint8_t kind);
+
+private:
+    void track(int16_t x, int16_t y);
+
+    const GestureCfg& cfg_;
+
+    bool active_ = false;
+    bool moved_ = false;
+    bool longFired_ = false;
+    int16_t x0_ = 0, y0_ = 0, x_ = 0, y_ = 0;
+    uint32_t t0_ = 0;
+
+    bool haveAngle_ = false;
+    uint16_t lastAngle_ = 0;
+    int32_t rot_ = 0;
+    uint32_t minR2_ = 0, maxR2_ = 0;
+};
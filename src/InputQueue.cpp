@@ -0,0 +1,42 @@
+#include "InputQueue.h"
+#include "AppConfig.h"
+#include "SpscRing.h"
+
+#include <esp_timer.h>
+
+static SpscRing<InputEvent, InputCfg::QUEUE_LEN> g_ring;
+static InputQueue::Stats g_stats;
+
+namespace InputQueue {
+
+bool push(uint8_t src, uint8_t code, int16_t a, int16_t b, uint32_t tUs) {
+    InputEvent e;
+    e.tUs = tUs ? tUs : (uint32_t)esp_timer_get_time();
+    e.src = src;
+    e.code = code;
+    e.a = a;
+    e.b = b;
+
+    if (!g_ring.push(e)) {
+        g_stats.overflows++;
+        return false;
+    }
+    g_stats.pushed++;
+    uint32_t n = g_ring.size();
+    if (n > g_stats.highWater) g_stats.highWater = n;
+    return true;
+}
+
+bool pop(InputEvent& out) {
+    return g_ring.pop(out);
+}
+
+uint32_t size() {
+    return g_ring.size();
+}
+
+const Stats& stats() {
+    return g_stats;
+}
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <Arduino.h>
+
+// Input as a fixed-size record; turned into text only when dispatched
+struct InputEvent {
+    enum Src : uint8_t { Button, EncKey, Encoder, Touch, Gesture };
+    enum TouchCode : uint8_t { TouchDown, TouchUp, TouchMove };
+
+    uint32_t tUs;   // when it was sampled
+    uint8_t src;
+    uint8_t code;   // Button: idx, EncKey/Encoder: 1..2, Touch: TouchCode, Gesture: kind
+    int16_t a;      // Button: KeyEvent, EncKey: 1 = long, Encoder: delta, Touch: x, Gesture: a
+    int16_t b;      // Touch: y, Gesture: b
+};
+
+// Statically allocated ring between the input handlers and the dispatcher.
+// When full the new event is dropped and counted.
+namespace InputQueue {
+    struct Stats {
+        uint32_t pushed;
+        uint32_t overflows;
+        uint32_t highWater;
+    };
+
+    bool push(uint8_t src, uint8_t code, int16_t a = 0, int16_t b = 0, uint32_t tUs = 0);
+    bool pop(InputEvent& out);
+    uint32_t size();
+
+    const Stats& stats();
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <stdint.h>
+
+enum class KeyEvent : uint8_t { Click, Long, Double, Repeat };
+
+// Behaviour of one key, all times in ms
+struct KeySpec {
+    uint16_t longMs;         // 0 = no long press
+    uint16_t doubleMs;       // 0 = no double click, click fires on release
+    uint16_t repeatDelayMs;  // 0 = no auto-repeat; else click on press, repeats while held
+    uint16_t repeatStartMs;  // first repeat interval
+    uint16_t repeatMinMs;    // interval floor
+    uint8_t  repeatStepPct;  // each repeat shortens the interval by this much
+};
+
+// Click / long / double / hold-repeat for N debounced keys, driven by a
+// constexpr KeySpec table. edge() takes debounced press/release edges,
+// tick() fires the time-based events; both are O(1) per key and emit via
+// emit(key, KeyEvent, tUs). Times are microseconds, wraparound-safe.
+template <uint8_t N>
+class KeyMachine {
+public:
+    explicit constexpr KeyMachine(const KeySpec (&table)[N]) : table_(table) {}
+
+    // Keys already held at start release as a normal press; repeat keys are
+    // ignored until they go up
+    void reset(uint32_t pressed, uint32_t nowUs) {
+        for (uint8_t k = 0; k < N; k++) {
+            bool down = (pressed >> k) & 1;
+            keys_[k].st = (down && !table_[k].repeatDelayMs) ? Down : Idle;
+            keys_[k].t = nowUs;
+        }
+    }
+
+    template <typename Emit>
+    void edge(uint8_t k, bool down, uint32_t tUs, Emit&& emit) {
+        if (k >= N) return;
+        const KeySpec& s = table_[k];
+        Key& key = keys_[k];
+
+        if (down) {
+            if (key.st == Idle) {
+                if (s.repeatDelayMs) emit(k, KeyEvent::Click, tUs);
+                key.st = Down;
+                key.t = tUs;
+            } else if (key.st == WaitSecond) {
+                if ((tUs - key.t) < ms(s.doubleMs)) {
+                    key.st = DownSecond;
+                } else {
+                    // window ran out before tick() saw it: the first press was a click
+                    emit(k, KeyEvent::Click, key.t);
+                    key.st = Down;
+                }
+                key.t = tUs;
+            }
+            return;
+        }
+
+        switch (key.st) {
+            case Down:
+                key.st = Idle;
+                if (s.repeatDelayMs) break;
+                if (s.longMs && (tUs - key.t) >= ms(s.longMs)) {
+                    emit(k, KeyEvent::Long, tUs);
+                } else if (s.doubleMs) {
+                    key.st = WaitSecond;
+                    key.t = tUs;
+                } else {
+                    emit(k, KeyEvent::Click, tUs);
+                }
+                break;
+            case DownSecond:
+                key.st = Idle;
+                emit(k, KeyEvent::Double, tUs);
+                break;
+            case Repeating:
+                key.st = Idle;
+                break;
+            default:
+                break;
+        }
+    }
+
+    template <typename Emit>
+    void tick(uint32_t nowUs, Emit&& emit) {
+        for (uint8_t k = 0; k < N; k++) {
+            const KeySpec& s = table_[k];
+            Key& key = keys_[k];
+
+            switch (key.st) {
+                case Down:
+                    if (s.repeatDelayMs && (nowUs - key.t) >= ms(s.repeatDelayMs)) {
+                        emit(k, KeyEvent::Repeat, nowUs);
+                        key.st = Repeating;
+                        key.t = nowUs;
+                        key.intervalMs = s.repeatStartMs;
+                    }
+                    break;
+                case Repeating:
+                    if ((nowUs - key.t) >= ms(key.intervalMs)) {
+                        emit(k, KeyEvent::Repeat, nowUs);
+                        key.t = nowUs;
+                        uint16_t next = (uint16_t)((uint32_t)key.intervalMs * (100 - s.repeatStepPct) / 100);
+                        key.intervalMs = (next < s.repeatMinMs) ? s.repeatMinMs : next;
+                    }
+                    break;
+                case WaitSecond:
+                    if ((nowUs - key.t) >= ms(s.doubleMs)) {
+                        key.st = Idle;
+                        emit(k, KeyEvent::Click, key.t);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+private:
+    enum State : uint8_t { Idle, Down, Repeating, WaitSecond, DownSecond };
+
+    struct Key {
+        uint8_t st = Idle;
+        uint16_t intervalMs = 0;
+        uint32_t t = 0;
+    };
+
+    static constexpr uint32_t ms(uint16_t v) { return (uint32_t)v * 1000UL; }
+
+    const KeySpec (&table_)[N];
+    Key keys_[N];
+};
@@ -0,0 +1,81 @@
+#include "KeySampler.h"
+#include "AppConfig.h"
+#include "Mux.h"
+#include "SpscRing.h"
+
+#include <atomic>
+#include <esp_timer.h>
+
+static esp_timer_handle_t g_timer = nullptr;
+static VerticalDebounce g_deb;
+static std::atomic<uint16_t> g_state{0};
+static SpscRing<KeyEdge, BtnCfg::EDGE_QUEUE> g_edges;
+static KeySampler::Stats g_stats;
+static void (*g_onEdge)() = nullptr;
+static uint32_t g_busyUs = 0;
+
+static void setPeriod(bool idle) {
+    if (g_stats.idle == idle) return;
+    g_stats.idle = idle;
+    g_stats.idleSwitches++;
+    esp_timer_stop(g_timer);
+    esp_timer_start_periodic(g_timer, idle ? BtnCfg::SAMPLE_IDLE_US : BtnCfg::SAMPLE_US);
+}
+
+// esp_timer task context; the only MUX user after begin()
+static void onSample(void*) {
+    uint32_t t = (uint32_t)esp_timer_get_time();
+    uint16_t raw = Mux::scan();
+    uint16_t flipped = g_deb.update(raw);
+    g_stats.samples++;
+
+    // anything pressed or still settling keeps the fast rate
+    if (raw || g_deb.state) {
+        g_busyUs = t;
+        setPeriod(false);
+    } else if (t - g_busyUs >= BtnCfg::SAMPLE_IDLE_AFTER_MS * 1000UL) {
+        setPeriod(true);
+    }
+
+    if (!flipped) return;
+
+    g_state.store(g_deb.state, std::memory_order_release);
+    for (uint8_t ch = 0; ch < 16; ch++) {
+        if (!((flipped >> ch) & 1)) continue;
+        KeyEdge e{t, ch, (bool)((g_deb.state >> ch) & 1)};
+        if (g_edges.push(e)) g_stats.edges++;
+        else g_stats.dropped++;
+    }
+    if (g_onEdge) g_onEdge();
+}
+
+namespace KeySampler {
+
+void begin(void (*onEdge)()) {
+    g_onEdge = onEdge;
+    g_deb.state = Mux::scan();
+    g_state.store(g_deb.state);
+    g_busyUs = (uint32_t)esp_timer_get_time();
+
+    esp_timer_create_args_t args = {};
+    args.callback = onSample;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "keys";
+    if (esp_timer_create(&args, &g_timer) == ESP_OK) {
+        esp_timer_start_periodic(g_timer, BtnCfg::SAMPLE_US);
+    }
+}
+
+bool pop(KeyEdge& out) {
+    return g_edges.pop(out);
+}
+
+uint16_t state() {
+    return g_state.load(std::memory_order_acquire);
+}
+
+const Stats& stats() {
+    return g_stats;
+}
+
+}
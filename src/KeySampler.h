@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+
+#include "VerticalDebounce.h"
+
+// Press/release of one MUX channel after debouncing
+struct KeyEdge {
+    uint32_t tUs;
+    uint8_t ch;
+    bool down;
+};
+
+// Samples the MUX from an esp_timer every BtnCfg::SAMPLE_US, independent of
+// loop() timing, and queues debounced edges for the loop to classify. With
+// nothing pressed for SAMPLE_IDLE_AFTER_MS it drops to SAMPLE_IDLE_US.
+namespace KeySampler {
+    struct Stats {
+        uint32_t samples;
+        uint32_t edges;
+        uint32_t dropped;    // edge queue full
+        uint32_t idleSwitches;
+        bool idle;           // running at SAMPLE_IDLE_US
+    };
+
+    // Seeds the debounced state with the current keys, then starts the timer.
+    // onEdge runs in the timer task after edges were queued.
+    void begin(void (*onEdge)() = nullptr);
+
+    bool pop(KeyEdge& out);
+
+    // Debounced state, bit = MUX channel pressed
+    uint16_t state();
+
+    const Stats& stats();
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer latest-value slot (triple buffer).
+// post() never blocks or fails: a value the consumer hasn't taken yet is
+// replaced. post() only from the producer, take() only from the consumer.
+template <typename T>
+class Mailbox {
+public:
+    void post(const T& v) {
+        buf_[back_] = v;
+        uint8_t prev = mid_.exchange((uint8_t)(back_ | FRESH), std::memory_order_acq_rel);
+        back_ = prev & IDX;
+        if (prev & FRESH) overwritten_++;
+    }
+
+    bool take(T& out) {
+        if (!(mid_.load(std::memory_order_relaxed) & FRESH)) return false;
+        uint8_t prev = mid_.exchange(front_, std::memory_order_acq_rel);
+        front_ = prev & IDX;
+        out = buf_[front_];
+        return true;
+    }
+
+    // values replaced before the consumer took them, producer side
+    uint32_t overwritten() const { return overwritten_; }
+
+private:
+    static constexpr uint8_t IDX   = 0x03;
+    static constexpr uint8_t FRESH = 0x04;
+
+    T buf_[3];
+    uint8_t back_ = 0;                      // producer's
+    std::atomic<uint8_t> mid_{1};           // handed over, FRESH when not yet taken
+    uint8_t front_ = 2;                     // consumer's
+    uint32_t overwritten_ = 0;
+};
@@ -0,0 +1,104 @@
+#include "Mux.h"
+#include "AppConfig.h"
+#include "MuxSelect.h"
+#include <soc/gpio_struct.h>
+
+static_assert(Pins::MUX_S0 < 32 && Pins::MUX_S1 < 32 && Pins::MUX_S2 < 32 && Pins::MUX_S3 < 32,
+              "MUX select pins must be in GPIO bank 0 (out_w1ts/out_w1tc)");
+static_assert(Pins::MUX_SIG >= 32, "MUX SIG is read from GPIO.in1");
+
+// bank 0 set/clear registers
+struct GpioBank0 {
+    static inline void set(uint32_t m) { GPIO.out_w1ts = m; }
+    static inline void clear(uint32_t m) { GPIO.out_w1tc = m; }
+};
+
+static MuxSelect<GpioBank0, Pins::MUX_S0, Pins::MUX_S1, Pins::MUX_S2, Pins::MUX_S3> g_sel;
+static uint32_t g_mhz = 240;
+static uint32_t g_settleCycles = 0;
+static Mux::Stats g_stats;
+
+static inline void selectLegacy(uint8_t ch) {
+    digitalWrite(Pins::MUX_S0, (ch >> 0) & 1);
+    digitalWrite(Pins::MUX_S1, (ch >> 1) & 1);
+    digitalWrite(Pins::MUX_S2, (ch >> 2) & 1);
+    digitalWrite(Pins::MUX_S3, (ch >> 3) & 1);
+}
+
+static inline void settle(uint32_t cycles) {
+    uint32_t t0 = ESP.getCycleCount();
+    while (ESP.getCycleCount() - t0 < cycles) {}
+}
+
+static inline bool sigLow() {
+    return ((GPIO.in1.val >> (Pins::MUX_SIG - 32)) & 1) == 0;
+}
+
+static inline bool sample(uint8_t ch, uint32_t settleCycles) {
+    if (MuxCfg::FAST_SELECT) {
+        g_sel.select(ch);
+        settle(settleCycles);
+        return sigLow();
+    }
+    selectLegacy(ch);
+    delayMicroseconds(MuxCfg::LEGACY_SETTLE_US);
+    return digitalRead(Pins::MUX_SIG) == LOW;
+}
+
+static uint16_t scanWith(uint32_t settleCycles) {
+    uint16_t mask = 0;
+    for (uint8_t i = 0; i < 16; i++) {
+        uint8_t ch = g_sel.scanChannel(i);
+        if (sample(ch, settleCycles)) mask |= (uint16_t)(1u << ch);
+    }
+    return mask;
+}
+
+namespace Mux {
+
+void begin() {
+    pinMode(Pins::MUX_S0, OUTPUT);
+    pinMode(Pins::MUX_S1, OUTPUT);
+    pinMode(Pins::MUX_S2, OUTPUT);
+    pinMode(Pins::MUX_S3, OUTPUT);
+    pinMode(Pins::MUX_EN, OUTPUT);
+    digitalWrite(Pins::MUX_EN, LOW);
+    pinMode(Pins::MUX_SIG, INPUT_PULLUP);
+
+    g_mhz = ESP.getCpuFreqMHz();
+    g_settleCycles = (uint32_t)MuxCfg::SETTLE_NS * g_mhz / 1000;
+    if (MuxCfg::FAST_SELECT) g_sel.reset(0);
+    else selectLegacy(0);
+}
+
+uint16_t scan() {
+    uint32_t t0 = ESP.getCycleCount();
+    uint16_t mask = scanWith(g_settleCycles);
+    uint32_t dt = ESP.getCycleCount() - t0;
+
+    g_stats.scans++;
+    g_stats.lastCycles = dt;
+    g_stats.sumCycles += dt;
+    if (dt > g_stats.maxCycles) g_stats.maxCycles = dt;
+    return mask;
+}
+
+uint16_t checkSettle() {
+    uint16_t fast = scanWith(g_settleCycles);
+    uint16_t slow = scanWith(g_mhz * 50);   // 50 us, far beyond any 4067 settle
+    uint16_t diff = fast ^ slow;
+
+    g_stats.settleChecks++;
+    g_stats.settleErrors += (uint32_t)__builtin_popcount(diff);
+    return diff;
+}
+
+uint32_t cpuMHz() {
+    return g_mhz;
+}
+
+const Stats& stats() {
+    return g_stats;
+}
+
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+
+// 74HC4067 button matrix. Channel select goes straight to the GPIO set/clear
+// registers through MuxSelect; scan() walks the channels in Gray-code order
+// so every step flips exactly one select line and needs a single write.
+namespace Mux {
+    struct Stats {
+        uint32_t scans;
+        uint32_t lastCycles;
+        uint32_t maxCycles;
+        uint64_t sumCycles;
+        uint32_t settleChecks;
+        uint32_t settleErrors;   // channels that read differently after a long settle
+    };
+
+    void begin();
+
+    // All 16 channels, bit ch set = pressed
+    uint16_t scan();
+
+    // Fast scan followed by a slow one; differing bits mean SETTLE_NS is too
+    // short. Busy-waits ~1 ms, so it runs from setup() before the sampler.
+    uint16_t checkSettle();
+
+    uint32_t cpuMHz();
+    const Stats& stats();
+}
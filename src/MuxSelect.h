@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+
+// 4067 channel select over a GPIO port with atomic set/clear registers:
+// Port::set(mask) drives the mask bits high, Port::clear(mask) low. A select
+// change is at most one write of each; scan order is Gray code, so every
+// step of a scan flips exactly one line and costs a single write.
+// Plain C++, so it also builds on the host against a mock port.
+template <class Port, uint8_t S0, uint8_t S1, uint8_t S2, uint8_t S3>
+class MuxSelect {
+public:
+    // GPIO mask of the select lines that are high for value v
+    static constexpr uint32_t lines(uint8_t v) {
+        return ((v & 1) ? (1u << S0) : 0) |
+               ((v & 2) ? (1u << S1) : 0) |
+               ((v & 4) ? (1u << S2) : 0) |
+               ((v & 8) ? (1u << S3) : 0);
+    }
+
+    // Channel visited at step i of a scan
+    static constexpr uint8_t scanChannel(uint8_t i) { return (uint8_t)((i ^ (i >> 1)) & 0x0F); }
+
+    // Drives every line, for when the current state isn't known
+    void reset(uint8_t ch) {
+        ch &= 0x0F;
+        Port::set(lines(ch));
+        Port::clear(lines((uint8_t)(~ch & 0x0F)));
+        cur_ = ch;
+    }
+
+    void select(uint8_t ch) {
+        ch &= 0x0F;
+        uint8_t diff = ch ^ cur_;
+        if (!diff) return;
+        uint32_t set = MASK.m[diff & ch];
+        uint32_t clr = MASK.m[diff & (uint8_t)~ch];
+        if (set) Port::set(set);
+        if (clr) Port::clear(clr);
+        cur_ = ch;
+    }
+
+    uint8_t current() const { return cur_; }
+
+private:
+    struct Table { uint32_t m[16]; };
+
+    static constexpr Table makeTable() {
+        Table t{};
+        for (uint8_t v = 0; v < 16; v++) t.m[v] = lines(v);
+        return t;
+    }
+
+    static constexpr Table MASK = makeTable();
+
+    uint8_t cur_ = 0;
+};
@@ -0,0 +1,34 @@
+#include "OledPages.h"
+
+void OledPageFlusher::begin(uint8_t w, uint8_t h, uint8_t addr, uint32_t clkDuring, uint32_t clkAfter, uint8_t dataChunk) {
+    w_ = (w > MAX_W) ? MAX_W : w;
+    pages_ = (uint8_t)((h + 7) / 8);
+    if (pages_ > MAX_PAGES) pages_ = MAX_PAGES;
+    addr_ = addr;
+    chunk_ = dataChunk ? dataChunk : 1;
+    clkDuring_ = clkDuring;
+    clkAfter_ = clkAfter;
+    stale_ = 0xFF;
+    resume_ = 0;
+    pending_ = false;
+}
+
+bool OledPageFlusher::dirtyRange(const uint8_t* buf, uint8_t p, uint8_t& c0, uint8_t& c1) const {
+    const uint8_t* row = buf + (uint16_t)p * w_;
+    const uint8_t* shadow = shadow_ + (uint16_t)p * w_;
+
+    int16_t first = 0, last = w_ - 1;
+    if (!(stale_ & (1u << p))) {
+        while (first < w_ && row[first] == shadow[first]) first++;
+        if (first == w_) return false;
+        while (row[last] == shadow[last]) last--;
+    }
+    c0 = (uint8_t)first;
+    c1 = (uint8_t)last;
+    return true;
+}
+
+uint32_t OledPageFlusher::pageBytes(uint8_t c0, uint8_t c1) const {
+    uint32_t n = (uint32_t)(c1 - c0 + 1);
+    return ADDR_BYTES + n + 2 * ((n + chunk_ - 1) / chunk_);
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// Sends only the SSD1306 pages (and the column range inside each page) that
+// differ from what the panel already shows, instead of oled.display()
+// pushing the whole 1 KB framebuffer every time.
+// A flush can be capped in bytes; pages left over stay dirty against the
+// shadow and go out on the next call, starting where this one stopped.
+// Talks to the bus through any Wire-like object (beginTransmission, write,
+// endTransmission, setClock), so it also builds on the host.
+class OledPageFlusher {
+public:
+    static constexpr uint8_t MAX_W     = 128;
+    static constexpr uint8_t MAX_PAGES = 8;
+
+    // one addressing transaction: address, control, PAGEADDR p p, COLUMNADDR c0 c1
+    static constexpr uint32_t ADDR_BYTES = 8;
+
+    struct Stats {
+        uint32_t flushes;
+        uint32_t pages;      // page writes
+        uint32_t bytes;      // I2C bytes on the wire incl. address/control
+        uint32_t partial;    // flushes cut short by their byte cap
+    };
+
+    // clkDuring/clkAfter: same I2C clocks the Adafruit driver was created with;
+    // dataChunk: data bytes per transmission, what the Wire buffer takes minus control
+    void begin(uint8_t w, uint8_t h, uint8_t addr, uint32_t clkDuring, uint32_t clkAfter, uint8_t dataChunk);
+
+    // Forget the shadow copy; the next flushes send every page
+    void invalidate() { stale_ = 0xFF; }
+
+    // buf: the driver's framebuffer (oled.getBuffer()). Sends at least one
+    // changed page, then stops before a page that would go past maxBytes.
+    // Returns I2C bytes sent for this flush (0 if nothing changed)
+    template <class Wire>
+    uint32_t flush(const uint8_t* buf, Wire& wire, uint32_t maxBytes = UINT32_MAX);
+
+    // The last flush stopped at its cap with changed pages left
+    bool pending() const { return pending_; }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    static constexpr uint8_t CMD_PAGEADDR   = 0x22;
+    static constexpr uint8_t CMD_COLUMNADDR = 0x21;
+    static constexpr uint8_t CTRL_CMDS      = 0x00;     // Co=0, D/C#=0: command stream
+    static constexpr uint8_t CTRL_DATA      = 0x40;
+
+    // Changed column range of page p; false when it matches the shadow
+    bool dirtyRange(const uint8_t* buf, uint8_t p, uint8_t& c0, uint8_t& c1) const;
+
+    // bytes sendPage() puts on the wire for c0..c1
+    uint32_t pageBytes(uint8_t c0, uint8_t c1) const;
+
+    template <class Wire>
+    uint32_t sendPage(Wire& wire, uint8_t page, uint8_t c0, uint8_t c1, const uint8_t* data);
+
+    uint8_t shadow_[MAX_W * MAX_PAGES];
+    uint8_t w_ = MAX_W;
+    uint8_t pages_ = MAX_PAGES;
+    uint8_t addr_ = 0x3C;
+    uint8_t chunk_ = 31;
+    uint32_t clkDuring_ = 400000;
+    uint32_t clkAfter_ = 100000;
+    uint8_t stale_ = 0xFF;      // pages whose shadow doesn't hold what the panel shows
+    uint8_t resume_ = 0;        // first page the next flush looks at
+    bool pending_ = false;
+    Stats stats_ = {0, 0, 0, 0};
+};
+
+template <class Wire>
+uint32_t OledPageFlusher::sendPage(Wire& wire, uint8_t page, uint8_t c0, uint8_t c1, const uint8_t* data) {
+    wire.beginTransmission(addr_);
+    wire.write(CTRL_CMDS);
+    wire.write(CMD_PAGEADDR);
+    wire.write(page);
+    wire.write(page);
+    wire.write(CMD_COLUMNADDR);
+    wire.write(c0);
+    wire.write(c1);
+    wire.endTransmission();
+    uint32_t bytes = ADDR_BYTES;
+
+    uint16_t n = (uint16_t)(c1 - c0 + 1);
+    while (n > 0) {
+        uint8_t chunk = (n > chunk_) ? chunk_ : (uint8_t)n;
+        wire.beginTransmission(addr_);
+        wire.write(CTRL_DATA);
+        wire.write(data, chunk);
+        wire.endTransmission();
+
+        bytes += 2 + chunk;
+        data += chunk;
+        n -= chunk;
+    }
+    return bytes;
+}
+
+template <class Wire>
+uint32_t OledPageFlusher::flush(const uint8_t* buf, Wire& wire, uint32_t maxBytes) {
+    uint32_t bytes = 0;
+    uint8_t start = resume_;
+    resume_ = 0;
+    pending_ = false;
+
+    for (uint8_t k = 0; k < pages_; k++) {
+        uint8_t p = (uint8_t)((start + k) % pages_);
+        uint8_t c0, c1;
+        if (!dirtyRange(buf, p, c0, c1)) continue;
+
+        if (bytes && bytes + pageBytes(c0, c1) > maxBytes) {
+            resume_ = p;
+            pending_ = true;
+            stats_.partial++;
+            break;
+        }
+        if (!bytes) wire.setClock(clkDuring_);
+
+        const uint8_t* row = buf + (uint16_t)p * w_;
+        bytes += sendPage(wire, p, c0, c1, row + c0);
+        memcpy(shadow_ + (uint16_t)p * w_ + c0, row + c0, (size_t)(c1 - c0 + 1));
+        stale_ &= (uint8_t)~(1u << p);
+        stats_.pages++;
+    }
+
+    if (bytes) {
+        wire.setClock(clkAfter_);
+        stats_.flushes++;
+        stats_.bytes += bytes;
+    }
+    return bytes;
+}
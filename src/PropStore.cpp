@@ -0,0 +1,139 @@
+#include "PropStore.h"
+#include <string.h>
+
+static_assert((PropStore::CAPACITY & (PropStore::CAPACITY - 1)) == 0, "PropStore capacity must be a power of two");
+static_assert(PropStore::CAPACITY < PropStore::NONE, "Ref must fit a slot index");
+
+uint32_t PropStore::hash(uint32_t id, int32_t area) {
+    uint32_t h = id * 0x9E3779B1u ^ (uint32_t)area * 0x85EBCA6Bu;
+    return h ^ (h >> 16);
+}
+
+PropStore::Ref PropStore::find(uint32_t id, int32_t area) const {
+    uint32_t i = hash(id, area);
+    for (uint8_t n = 0; n < CAPACITY; n++, i++) {
+        const Slot& s = slots_[i & (CAPACITY - 1)];
+        if (!s.used) return NONE;
+        if (s.id == id && s.area == area) return (Ref)(i & (CAPACITY - 1));
+    }
+    return NONE;
+}
+
+PropStore::Ref PropStore::insert(uint32_t id, int32_t area) {
+    uint32_t i = hash(id, area);
+    for (uint8_t n = 0; n < CAPACITY; n++, i++) {
+        Slot& s = slots_[i & (CAPACITY - 1)];
+        if (s.used) {
+            if (s.id == id && s.area == area) return (Ref)(i & (CAPACITY - 1));
+            continue;
+        }
+        // keep one slot free so a miss always ends on an empty slot
+        if (stats_.count >= CAPACITY - 1) break;
+
+        s.used = true;
+        s.id = id;
+        s.area = area;
+        s.subs = watchersOf(id, area);
+        s.dirty = 0;
+        s.v.type = Type::None;
+        stats_.count++;
+        if (n > stats_.maxProbe) stats_.maxProbe = n;
+        return (Ref)(i & (CAPACITY - 1));
+    }
+    stats_.full++;
+    return NONE;
+}
+
+uint8_t PropStore::watchersOf(uint32_t id, int32_t area) const {
+    uint8_t m = 0;
+    for (uint8_t w = 0; w < watchCount_; w++) {
+        const Watch& x = watches_[w];
+        if (x.id == id && (x.area == ANY_AREA || x.area == area)) m |= (uint8_t)(1u << x.sub);
+    }
+    return m;
+}
+
+void PropStore::changed(Slot& s) {
+    stats_.changes++;
+    s.dirty |= s.subs;
+    pending_ |= s.subs;
+}
+
+PropStore::Ref PropStore::setInt(uint32_t id, int32_t area, int32_t v) {
+    stats_.sets++;
+    Ref r = insert(id, area);
+    if (r == NONE) return r;
+
+    Slot& s = slots_[r];
+    if (s.v.type != Type::Int || s.v.i != v) {
+        s.v.type = Type::Int;
+        s.v.i = v;
+        changed(s);
+    }
+    return r;
+}
+
+PropStore::Ref PropStore::setFixed(uint32_t id, int32_t area, int32_t v) {
+    stats_.sets++;
+    Ref r = insert(id, area);
+    if (r == NONE) return r;
+
+    Slot& s = slots_[r];
+    if (s.v.type != Type::Fixed || s.v.i != v) {
+        s.v.type = Type::Fixed;
+        s.v.i = v;
+        changed(s);
+    }
+    return r;
+}
+
+PropStore::Ref PropStore::setText(uint32_t id, int32_t area, const char* str, size_t n) {
+    stats_.sets++;
+    Ref r = insert(id, area);
+    if (r == NONE) return r;
+
+    if (n > TEXT_LEN - 1) n = TEXT_LEN - 1;
+    Slot& s = slots_[r];
+    if (s.v.type != Type::Text || strncmp(s.v.text, str, n) != 0 || s.v.text[n] != '\0') {
+        s.v.type = Type::Text;
+        memcpy(s.v.text, str, n);
+        s.v.text[n] = '\0';
+        changed(s);
+    }
+    return r;
+}
+
+uint8_t PropStore::subscribe() {
+    if (subCount_ >= MAX_SUBS) return MAX_SUBS;
+    return subCount_++;
+}
+
+bool PropStore::watch(uint8_t sub, uint32_t id, int32_t area) {
+    if (sub >= subCount_ || watchCount_ >= MAX_WATCH) return false;
+    watches_[watchCount_++] = {id, area, sub};
+
+    // entries that already exist start out dirty for the new watcher
+    uint8_t bit = (uint8_t)(1u << sub);
+    for (Slot& s : slots_) {
+        if (!s.used || s.id != id || (area != ANY_AREA && s.area != area)) continue;
+        s.subs |= bit;
+        s.dirty |= bit;
+        pending_ |= bit;
+    }
+    return true;
+}
+
+bool PropStore::poll(uint8_t sub) {
+    uint8_t bit = (uint8_t)(1u << sub);
+    bool p = pending_ & bit;
+    pending_ &= (uint8_t)~bit;
+    return p;
+}
+
+bool PropStore::take(uint8_t sub, Ref r) {
+    if (r >= CAPACITY) return false;
+    uint8_t bit = (uint8_t)(1u << sub);
+    bool d = slots_[r].dirty & bit;
+    slots_[r].dirty &= (uint8_t)~bit;
+    return d;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Vehicle properties keyed by (property id, area), statically allocated.
+// Lookup is one hash plus a short linear probe; entries are never removed.
+// Each entry carries a dirty bit per subscriber: a set that changes the
+// value marks it for every subscriber watching that id/area, and the
+// subscriber takes the bit when it redraws the field.
+// Plain C++, so it also builds on the host.
+class PropStore {
+public:
+    static constexpr uint8_t CAPACITY = 64;     // power of two
+    static constexpr uint8_t MAX_SUBS = 8;
+    static constexpr uint8_t MAX_WATCH = 16;
+    static constexpr uint8_t TEXT_LEN = 12;
+    static constexpr int32_t ANY_AREA = INT32_MIN;
+
+    using Ref = uint8_t;
+    static constexpr Ref NONE = 0xFF;
+
+    enum class Type : uint8_t { None, Int, Fixed, Text };
+
+    struct Value {
+        Type type;
+        int32_t i;              // Int, or Fixed in RxParser::FIXED_SCALE units
+        char text[TEXT_LEN];    // Text, '\0'-terminated
+    };
+
+    struct Stats {
+        uint32_t sets;
+        uint32_t changes;
+        uint32_t full;          // new keys refused, table full
+        uint8_t  count;
+        uint8_t  maxProbe;
+    };
+
+    Ref find(uint32_t id, int32_t area) const;
+
+    // Stored entry or NONE when the table is full
+    Ref setInt(uint32_t id, int32_t area, int32_t v);
+    Ref setFixed(uint32_t id, int32_t area, int32_t v);
+    Ref setText(uint32_t id, int32_t area, const char* s, size_t n);
+
+    // nullptr for NONE
+    const Value* get(Ref r) const { return (r < CAPACITY && slots_[r].used) ? &slots_[r].v : nullptr; }
+    const Value* get(uint32_t id, int32_t area) const { return get(find(id, area)); }
+
+    // MAX_SUBS when all subscriber slots are taken
+    uint8_t subscribe();
+
+    // Changes to id (in one area, or in any) mark sub's dirty bit
+    bool watch(uint8_t sub, uint32_t id, int32_t area = ANY_AREA);
+
+    // Whether anything sub watches changed since the last poll
+    bool poll(uint8_t sub);
+
+    // Whether entry r changed for sub since the last take; clears the bit
+    bool take(uint8_t sub, Ref r);
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct Slot {
+        uint32_t id;
+        int32_t area;
+        bool used;
+        uint8_t subs;       // watchers
+        uint8_t dirty;      // watchers that have not taken the change yet
+        Value v;
+    };
+
+    struct Watch {
+        uint32_t id;
+        int32_t area;
+        uint8_t sub;
+    };
+
+    static uint32_t hash(uint32_t id, int32_t area);
+    Ref insert(uint32_t id, int32_t area);
+    uint8_t watchersOf(uint32_t id, int32_t area) const;
+    void changed(Slot& s);
+
+    Slot slots_[CAPACITY] = {};
+    Watch watches_[MAX_WATCH] = {};
+    uint8_t watchCount_ = 0;
+    uint8_t subCount_ = 0;
+    uint8_t pending_ = 0;
+    Stats stats_{};
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+
+// x4 quadrature as PcntEncoder sets up the PCNT unit to count it, kept as
+// plain data so the host can check it against AiEsp32RotaryEncoder's
+// transition table: A leading B (A rises while B is low) counts down, the
+// same sign the library gives. Also the counter unwrap and detent math.
+// Plain C++, so it also builds on the host.
+namespace QuadDecode {
+    // PCNT_COUNT_DEC / PCNT_COUNT_INC
+    enum Action : int8_t { DEC = -1, INC = 1 };
+
+    // One PCNT channel: edges of the pulse pin count pos/neg while the
+    // control pin is high, and the other way round while it is low
+    struct Channel {
+        Action pos;
+        Action neg;
+    };
+
+    static constexpr Channel EDGES_A = {INC, DEC};   // pulse A, control B
+    static constexpr Channel EDGES_B = {DEC, INC};   // pulse B, control A
+
+    // Counts for one pin transition, AB = (B << 1) | A. Both pins changing
+    // at once isn't a quadrature step and counts nothing.
+    constexpr int8_t count(uint8_t oldAB, uint8_t newAB) {
+        uint8_t moved = (uint8_t)((oldAB ^ newAB) & 3);
+        if (moved == 1) {
+            int8_t c = (newAB & 1) ? EDGES_A.pos : EDGES_A.neg;
+            return (newAB & 2) ? c : (int8_t)-c;
+        }
+        if (moved == 2) {
+            int8_t c = (newAB & 2) ? EDGES_B.pos : EDGES_B.neg;
+            return (newAB & 1) ? c : (int8_t)-c;
+        }
+        return 0;
+    }
+
+    // Follows a 16-bit counter that resets to 0 on reaching +-limit, so it
+    // only has to be read more often than limit/2 counts
+    class Unwrap {
+    public:
+        constexpr Unwrap(int16_t limit, uint8_t perDetent)
+            : limit_(limit), perDetent_(perDetent ? perDetent : 1) {}
+
+        void reset() {
+            last_ = 0;
+            total_ = 0;
+        }
+
+        // Detents since reset() for the counter's current value
+        long update(int16_t raw) {
+            // take the short way round the reset
+            int32_t d = (int32_t)raw - last_;
+            if (d > limit_ / 2) d -= limit_;
+            else if (d < -limit_ / 2) d += limit_;
+            last_ = raw;
+            total_ += d;
+
+            // floor division, so there's no double-width detent around zero
+            long n = perDetent_;
+            return (total_ >= 0) ? total_ / n : -((-total_ + n - 1) / n);
+        }
+
+        long counts() const { return total_; }
+
+    private:
+        int16_t limit_;
+        uint8_t perDetent_;
+        int16_t last_ = 0;
+        long total_ = 0;
+    };
+}
@@ -0,0 +1,173 @@
+#include "RxParser.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace RxParser {
+
+bool Token::is(const char* lit) const {
+    size_t l = strlen(lit);
+    return l == n && memcmp(p, lit, l) == 0;
+}
+
+bool parseInt(const char* p, size_t n, int32_t* out) {
+    bool neg = false;
+    size_t i = 0;
+    if (i < n && (p[i] == '-' || p[i] == '+')) neg = (p[i++] == '-');
+    if (i == n) return false;
+
+    uint32_t v = 0;
+    const uint32_t lim = neg ? 0x80000000u : 0x7FFFFFFFu;
+    for (; i < n; i++) {
+        uint32_t d = (uint32_t)(uint8_t)p[i] - '0';
+        if (d > 9) return false;
+        if (v > (lim - d) / 10) return false;
+        v = v * 10 + d;
+    }
+    *out = neg ? (int32_t)(0u - v) : (int32_t)v;
+    return true;
+}
+
+bool parseFixed(const char* p, size_t n, int32_t* out) {
+    bool neg = false;
+    size_t i = 0;
+    if (i < n && (p[i] == '-' || p[i] == '+')) neg = (p[i++] == '-');
+
+    uint32_t v = 0;
+    uint8_t digits = 0, frac = 0;
+    bool dot = false;
+    const uint32_t lim = 0x7FFFFFFFu;
+    for (; i < n; i++) {
+        char c = p[i];
+        if (c == '.' && !dot) { dot = true; continue; }
+        uint32_t d = (uint32_t)(uint8_t)c - '0';
+        if (d > 9) return false;
+        digits++;
+        if (dot && frac >= FIXED_DIGITS) continue;   // truncate extra decimals
+        if (v > (lim - d) / 10) return false;
+        v = v * 10 + d;
+        if (dot) frac++;
+    }
+    if (!digits) return false;
+
+    for (; frac < FIXED_DIGITS; frac++) {
+        if (v > lim / 10) return false;
+        v *= 10;
+    }
+    *out = neg ? -(int32_t)v : (int32_t)v;
+    return true;
+}
+
+size_t formatFixed(char* out, size_t cap, int32_t v, uint8_t decimals) {
+    if (decimals > FIXED_DIGITS) decimals = FIXED_DIGITS;
+    uint32_t div = 1;
+    for (uint8_t i = decimals; i < FIXED_DIGITS; i++) div *= 10;
+
+    bool neg = v < 0;
+    uint32_t m = neg ? 0u - (uint32_t)v : (uint32_t)v;
+    m = (m + div / 2) / div;
+
+    uint32_t unit = 1;
+    for (uint8_t i = 0; i < decimals; i++) unit *= 10;
+
+    int w;
+    if (decimals) {
+        w = snprintf(out, cap, "%s%lu.%0*lu", (neg && m) ? "-" : "",
+                     (unsigned long)(m / unit), (int)decimals, (unsigned long)(m % unit));
+    } else {
+        w = snprintf(out, cap, "%s%lu", (neg && m) ? "-" : "", (unsigned long)m);
+    }
+    if (w < 0) return 0;
+    return ((size_t)w < cap) ? (size_t)w : (cap ? cap - 1 : 0);
+}
+
+Dispatcher::Dispatcher(const Command* table, uint8_t count, Handler fallback)
+    : table_(table), count_(count > MAX_CMDS ? MAX_CMDS : count), fallback_(fallback) {
+    memset(head_, NONE, sizeof(head_));
+
+    // chain in reverse so each bucket keeps table order
+    for (int i = (int)count_ - 1; i >= 0; i--) {
+        size_t l = strlen(table_[i].prefix);
+        len_[i] = (uint8_t)(l > 255 ? 255 : l);
+        uint8_t b = (uint8_t)table_[i].prefix[0] & 31;
+        next_[i] = head_[b];
+        head_[b] = (uint8_t)i;
+    }
+}
+
+// Splits s[0..n) into fields per schema; false if they don't line up
+static bool parseFields(const char* schema, const char* s, size_t n, Args& a) {
+    size_t pos = 0;
+    bool avail = n > 0;     // another field starts at pos
+    uint8_t k = 0;
+
+    for (const char* sc = schema; *sc; sc++, k++) {
+        if (k >= MAX_FIELDS) return false;
+        char kind = *sc;
+        bool optional = (kind >= 'a' && kind <= 'z');
+        if (optional) kind = (char)(kind - 'a' + 'A');
+
+        Field& f = a.f[k];
+        f.present = false;
+        f.i = 0;
+        f.tok = {s + pos, 0};
+        if (!avail) {
+            if (!optional) return false;
+            continue;
+        }
+
+        size_t end = pos;
+        if (kind == 'T' && !sc[1]) end = n;
+        else while (end < n && s[end] != ':') end++;
+
+        f.tok = {s + pos, (uint8_t)(end - pos > 255 ? 255 : end - pos)};
+        if (kind == 'I') {
+            if (!parseInt(s + pos, end - pos, &f.i)) return false;
+        } else if (kind == 'F') {
+            if (!parseFixed(s + pos, end - pos, &f.i)) return false;
+        } else if (kind != 'T') {
+            return false;
+        }
+        f.present = true;
+        a.count = k + 1;
+
+        avail = end < n;
+        pos = avail ? end + 1 : n;
+    }
+    return !avail;
+}
+
+bool Dispatcher::dispatch(const char* s, size_t n) {
+    Args a;
+    a.line = s;
+    a.lineLen = (uint8_t)(n > 255 ? 255 : n);
+    a.count = 0;
+
+    uint32_t* miss = &stats_.unknown;
+    if (n) {
+        for (uint8_t i = head_[(uint8_t)s[0] & 31]; i != NONE; i = next_[i]) {
+            const Command& c = table_[i];
+            if (len_[i] > n || memcmp(s, c.prefix, len_[i]) != 0) continue;
+
+            // a later entry with the same prefix may still take it
+            a.count = 0;
+            if (!parseFields(c.schema, s + len_[i], n - len_[i], a)) {
+                miss = &stats_.malformed;
+                continue;
+            }
+
+            if (c.handler(a)) {
+                stats_.handled++;
+                return true;
+            }
+            miss = &stats_.rejected;
+            break;
+        }
+    }
+
+    (*miss)++;
+    a.count = 0;
+    if (fallback_) fallback_(a);
+    return false;
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Table-driven parser for the ':'-separated text commands the phone writes.
+// A command is a literal prefix followed by fields described by a schema
+// string, one char per field:
+//   'I'  signed decimal int32
+//   'F'  decimal in fixed point, FIXED_SCALE units ("22.5" -> 2250)
+//   'T'  token; the last field of a schema takes the rest of the line
+// Lower case marks a field that may be missing at the end of the line.
+// Nothing is copied: tokens point into the input, which needs no '\0'.
+// Lookup goes through a bucket per first byte, then a prefix compare.
+// Plain C++, so it also builds on the host.
+namespace RxParser {
+    static constexpr uint8_t MAX_FIELDS  = 6;
+    static constexpr uint8_t MAX_CMDS    = 32;
+    static constexpr uint8_t FIXED_DIGITS = 2;
+    static constexpr int32_t FIXED_SCALE  = 100;
+
+    struct Token {
+        const char* p;
+        uint8_t n;
+
+        bool is(const char* lit) const;
+    };
+
+    struct Field {
+        bool present;
+        int32_t i;      // 'I' value, 'F' value in FIXED_SCALE units
+        Token tok;      // raw text of the field, for every kind
+    };
+
+    struct Args {
+        const char* line;   // whole message
+        uint8_t lineLen;
+        uint8_t count;      // fields present
+        Field f[MAX_FIELDS];
+    };
+
+    // false sends the message to the fallback, as if nothing had matched
+    using Handler = bool (*)(const Args& a);
+
+    struct Command {
+        const char* prefix;
+        const char* schema;     // "" = the prefix is the whole message
+        Handler handler;
+    };
+
+    struct Stats {
+        uint32_t handled;
+        uint32_t unknown;       // no prefix matched
+        uint32_t malformed;     // prefix matched, fields did not
+        uint32_t rejected;      // handler returned false
+    };
+
+    class Dispatcher {
+    public:
+        // The table must outlive the dispatcher; more than MAX_CMDS entries are ignored
+        Dispatcher(const Command* table, uint8_t count, Handler fallback);
+
+        // true when a command handled the message, otherwise fallback runs
+        bool dispatch(const char* s, size_t n);
+
+        const Stats& stats() const { return stats_; }
+
+    private:
+        static constexpr uint8_t NONE = 0xFF;
+
+        const Command* table_;
+        uint8_t count_;
+        Handler fallback_;
+        uint8_t len_[MAX_CMDS];
+        uint8_t next_[MAX_CMDS];
+        uint8_t head_[32];      // first byte & 31
+        Stats stats_{};
+    };
+
+    // Strict field parsers, false on anything but the whole token
+    bool parseInt(const char* p, size_t n, int32_t* out);
+    bool parseFixed(const char* p, size_t n, int32_t* out);
+
+    // "-1.25" from -125; decimals <= FIXED_DIGITS, rounded half away from zero
+    size_t formatFixed(char* out, size_t cap, int32_t v, uint8_t decimals);
+}
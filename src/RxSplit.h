@@ -0,0 +1,30 @@
+#pragma once
+#include <stddef.h>
+
+// Cuts one BLE write into pieces of at most cap bytes for the RX slots.
+// Pieces end on a line break, so a message is never split across slots;
+// only a single line longer than cap is cut, and the rest of that line is
+// skipped. Plain C++, so it also builds on the host.
+namespace RxSplit {
+    struct Piece {
+        size_t len;     // bytes of the piece, from the start of p
+        size_t next;    // where the following piece starts
+        bool cut;       // a line was longer than cap
+    };
+
+    inline bool isBreak(char c) { return c == '\n' || c == '\r'; }
+
+    inline Piece next(const char* p, size_t n, size_t cap) {
+        if (n <= cap) return {n, n, false};
+
+        // whole lines while they fit
+        for (size_t e = cap; e > 0; e--) {
+            if (isBreak(p[e - 1])) return {e, e, false};
+        }
+
+        // first line alone fills cap: keep its head, drop up to the next break
+        size_t e = cap;
+        while (e < n && !isBreak(p[e])) e++;
+        return {cap, e, e > cap};
+    }
+}
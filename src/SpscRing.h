@@ -0,0 +1,40 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+// Lock-free single-producer/single-consumer ring. N must be a power of two.
+// push() only from the producer, pop()/peek() only from the consumer.
+template <typename T, uint32_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing size must be a power of two");
+
+public:
+    bool push(const T& v) {
+        uint32_t h = head_.load(std::memory_order_relaxed);
+        if (h - tail_.load(std::memory_order_acquire) >= N) return false;
+        buf_[h & (N - 1)] = v;
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out) {
+        uint32_t t = tail_.load(std::memory_order_relaxed);
+        if (t == head_.load(std::memory_order_acquire)) return false;
+        out = buf_[t & (N - 1)];
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() >= N; }
+    static constexpr uint32_t capacity() { return N; }
+
+private:
+    std::atomic<uint32_t> head_{0};
+    std::atomic<uint32_t> tail_{0};
+    T buf_[N];
+};
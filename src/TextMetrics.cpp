@@ -0,0 +1,45 @@
+#include "TextMetrics.h"
+
+int16_t TextMetrics::width(const char* s, size_t n) const {
+    Run r;
+    for (size_t i = 0; i < n; i++) push(r, s[i]);
+    return r.width();
+}
+
+size_t TextMetrics::fit(const char* s, size_t n, int16_t maxW) const {
+    Run r;
+    for (size_t i = 0; i < n; i++) {
+        push(r, s[i]);
+        if (r.width() > maxW) return (i == 0) ? 1 : i;
+    }
+    return n;
+}
+
+bool TextMetrics::probe(int16_t* miny, int16_t* maxy) const {
+    *miny = 0x7FFF;
+    *maxy = -1;
+    for (const char* p = "Ay"; *p; p++) {
+        uint8_t c = (uint8_t)*p;
+        if (c < font_->first || c > font_->last) continue;
+        const GFXglyph& g = font_->glyph[c - font_->first];
+        int16_t y1 = (int16_t)g.yOffset * size_;
+        int16_t y2 = y1 + (int16_t)g.height * size_ - 1;
+        if (y1 < *miny) *miny = y1;
+        if (y2 > *maxy) *maxy = y2;
+    }
+    return *maxy >= *miny;
+}
+
+int16_t TextMetrics::lineHeight() const {
+    if (!font_) return size_ * 8;
+
+    int16_t miny, maxy;
+    return probe(&miny, &maxy) ? (int16_t)(maxy - miny + 1) : 8;
+}
+
+int16_t TextMetrics::ascent() const {
+    if (!font_) return 0;
+
+    int16_t miny, maxy;
+    return probe(&miny, &maxy) ? (int16_t)-miny : 0;
+}
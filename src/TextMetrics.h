@@ -0,0 +1,67 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <gfxfont.h>
+
+// Text measurement from glyph advances instead of getTextBounds().
+// Widths follow Adafruit_GFX::charBounds() exactly (text wrap off):
+// the built-in 5x7 font is a fixed 6*size cell, GFXfont glyphs use
+// xOffset/width/xAdvance scaled by size.
+class TextMetrics {
+public:
+    // Horizontal bounds of a run of glyphs, extended one char at a time
+    struct Run {
+        int16_t x    = 0;
+        int16_t minx = 0x7FFF;
+        int16_t maxx = -1;
+
+        int16_t width() const { return (maxx >= minx) ? (int16_t)(maxx - minx + 1) : 0; }
+    };
+
+    TextMetrics(const GFXfont* font, uint8_t size)
+        : font_(font), size_(size > 0 ? size : 1) {}
+
+    const GFXfont* font() const { return font_; }
+    uint8_t size() const { return size_; }
+
+    inline void push(Run& r, char ch) const {
+        uint8_t c = (uint8_t)ch;
+        if (c == '\n') { r.x = 0; return; }
+        if (c == '\r') return;
+
+        if (!font_) {
+            int16_t x2 = r.x + size_ * 6 - 1;
+            if (x2 > r.maxx) r.maxx = x2;
+            if (r.x < r.minx) r.minx = r.x;
+            r.x += size_ * 6;
+            return;
+        }
+
+        if (c < font_->first || c > font_->last) return;
+        const GFXglyph& g = font_->glyph[c - font_->first];
+        int16_t x1 = r.x + (int16_t)g.xOffset * size_;
+        int16_t x2 = x1 + (int16_t)g.width * size_ - 1;
+        if (x1 < r.minx) r.minx = x1;
+        if (x2 > r.maxx) r.maxx = x2;
+        r.x += (int16_t)g.xAdvance * size_;
+    }
+
+    int16_t width(const char* s, size_t n) const;
+
+    // Longest prefix of s[0..n) that fits into maxW (at least one char)
+    size_t fit(const char* s, size_t n, int16_t maxW) const;
+
+    // Height of "Ay", same as the old measureText() probe
+    int16_t lineHeight() const;
+
+    // Cursor y minus the top of that probe: GFXfont cursors sit on the
+    // baseline, the built-in font's on the top row
+    int16_t ascent() const;
+
+private:
+    // y extent of "Ay" relative to the cursor; false if no glyph has rows
+    bool probe(int16_t* miny, int16_t* maxy) const;
+
+    const GFXfont* font_;
+    uint8_t size_;
+};
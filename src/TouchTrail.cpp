@@ -0,0 +1,52 @@
+#include "TouchTrail.h"
+#include <cmath>
+
+bool TouchTrail::add(int16_t x, int16_t y) {
+    if (count_ > 0 && pts_[count_ - 1][0] == x && pts_[count_ - 1][1] == y) return true;
+
+    if (count_ == MAX_POINTS) {
+        pts_[count_ - 1][0] = x;
+        pts_[count_ - 1][1] = y;
+        return false;
+    }
+    pts_[count_][0] = x;
+    pts_[count_][1] = y;
+    count_++;
+    return true;
+}
+
+void TouchTrail::breakStroke() {
+    hasLast_ = false;
+}
+
+static void drawSegment(Adafruit_GFX& gfx, int16_t x0, int16_t y0, int16_t x1, int16_t y1,
+                        int16_t r, uint16_t color) {
+    int16_t dx = x1 - x0, dy = y1 - y0;
+    float len = sqrtf((float)dx * dx + (float)dy * dy);
+    if (len >= 1.0f) {
+        // half-width offset perpendicular to the segment
+        int16_t ox = (int16_t)lroundf(-dy * r / len);
+        int16_t oy = (int16_t)lroundf(dx * r / len);
+        gfx.fillTriangle(x0 + ox, y0 + oy, x0 - ox, y0 - oy, x1 - ox, y1 - oy, color);
+        gfx.fillTriangle(x0 + ox, y0 + oy, x1 - ox, y1 - oy, x1 + ox, y1 + oy, color);
+    }
+    gfx.fillCircle(x1, y1, r, color);
+}
+
+uint8_t TouchTrail::draw(Adafruit_GFX& gfx, int16_t radius, uint16_t color) {
+    uint8_t segs = 0;
+    for (uint8_t i = 0; i < count_; i++) {
+        int16_t x = pts_[i][0], y = pts_[i][1];
+        if (hasLast_) {
+            drawSegment(gfx, lastX_, lastY_, x, y, radius, color);
+            segs++;
+        } else {
+            gfx.fillCircle(x, y, radius, color);
+        }
+        lastX_ = x;
+        lastY_ = y;
+        hasLast_ = true;
+    }
+    count_ = 0;
+    return segs;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+#include <Adafruit_GFX.h>
+
+// Touch points collected between frames and drawn in one batch as thick
+// segments with round caps, continuing from where the last batch ended.
+class TouchTrail {
+public:
+    static constexpr uint8_t MAX_POINTS = 16;
+
+    // Returns false when the batch was full and the last point got replaced
+    bool add(int16_t x, int16_t y);
+
+    // Finger lifted: the next point starts a new stroke
+    void breakStroke();
+
+    bool empty() const { return count_ == 0; }
+
+    // Returns segments drawn
+    uint8_t draw(Adafruit_GFX& gfx, int16_t radius, uint16_t color);
+
+private:
+    int16_t pts_[MAX_POINTS][2];
+    uint8_t count_ = 0;
+
+    int16_t lastX_ = 0, lastY_ = 0;
+    bool hasLast_ = false;
+};
@@ -0,0 +1,22 @@
+#pragma once
+#include <stdint.h>
+
+// Debounces 16 inputs at once: a channel's state flips only after 4
+// consecutive samples disagree with it. cnt0/cnt1 are the per-bit 2-bit
+// counters, reset wherever the sample matches the state.
+// Plain C++, so it also builds on the host.
+struct VerticalDebounce {
+    uint16_t state = 0;
+    uint16_t cnt0 = 0;
+    uint16_t cnt1 = 0;
+
+    // Returns the bits that flipped
+    uint16_t update(uint16_t sample) {
+        uint16_t delta = sample ^ state;
+        cnt1 = (cnt1 ^ cnt0) & delta;
+        cnt0 = ~cnt0 & delta;
+        uint16_t toggle = delta & ~(cnt0 | cnt1);
+        state ^= toggle;
+        return toggle;
+    }
+};
@@ -0,0 +1,71 @@
+#include "Wake.h"
+
+#include <esp_timer.h>
+
+static StaticEventGroup_t g_groupBuf;
+static EventGroupHandle_t g_group = nullptr;
+
+// first set() since the last wake, for the latency figure
+static volatile uint32_t g_setUs = 0;
+static uint32_t g_lastReturnUs = 0;
+static Wake::Stats g_stats;
+
+// also runs from setFromISR()
+static void IRAM_ATTR stampSet() {
+    if (g_setUs == 0) g_setUs = (uint32_t)esp_timer_get_time() | 1;
+}
+
+namespace Wake {
+
+void begin() {
+    g_group = xEventGroupCreateStatic(&g_groupBuf);
+    g_lastReturnUs = (uint32_t)esp_timer_get_time();
+}
+
+void set(EventBits_t bits) {
+    if (!g_group) return;
+    stampSet();
+    xEventGroupSetBits(g_group, bits);
+}
+
+void IRAM_ATTR setFromISR(EventBits_t bits) {
+    if (!g_group) return;
+    stampSet();
+    BaseType_t woken = pdFALSE;
+    xEventGroupSetBitsFromISR(g_group, bits, &woken);
+    if (woken) portYIELD_FROM_ISR();
+}
+
+EventBits_t wait(uint32_t timeoutMs) {
+    if (!g_group) return 0;
+
+    uint32_t t0 = (uint32_t)esp_timer_get_time();
+    EventBits_t bits = xEventGroupWaitBits(g_group, ALL, pdTRUE, pdFALSE, pdMS_TO_TICKS(timeoutMs));
+    uint32_t t1 = (uint32_t)esp_timer_get_time();
+
+    g_stats.blockedUs += t1 - t0;
+    g_stats.totalUs += t1 - g_lastReturnUs;
+    g_lastReturnUs = t1;
+
+    bits &= ALL;
+    if (!bits) {
+        g_stats.timeouts++;
+        return 0;
+    }
+
+    g_stats.wakes++;
+    uint32_t setUs = g_setUs;
+    g_setUs = 0;
+    if (setUs) {
+        uint32_t lat = t1 - setUs;
+        if (lat > g_stats.latMaxUs) g_stats.latMaxUs = lat;
+        g_stats.latSumUs += lat;
+    }
+    return bits;
+}
+
+const Stats& stats() {
+    return g_stats;
+}
+
+}
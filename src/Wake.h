@@ -0,0 +1,36 @@
+#pragma once
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+// What loop() blocks on: producers set a bit, loop() sleeps in wait() until
+// a bit arrives or its next deadline passes.
+namespace Wake {
+    enum Bits : EventBits_t {
+        KEYS     = 1 << 0,   // debounced key edge
+        TOUCH    = 1 << 1,   // CST816S INT
+        RX       = 1 << 2,   // BLE write
+        BLE      = 1 << 3,   // connect / disconnect
+        ENCODER  = 1 << 4,   // ISR encoder backend
+        ALL      = KEYS | TOUCH | RX | BLE | ENCODER,
+    };
+
+    struct Stats {
+        uint32_t wakes;        // woken by a bit
+        uint32_t timeouts;     // woken by the deadline
+        uint64_t blockedUs;
+        uint64_t totalUs;
+        uint32_t latMaxUs;     // set() -> wait() returns
+        uint64_t latSumUs;
+    };
+
+    void begin();
+
+    void set(EventBits_t bits);
+    void setFromISR(EventBits_t bits);     // IRAM, safe with the flash cache off
+
+    // Returns the bits that were set, 0 on timeout
+    EventBits_t wait(uint32_t timeoutMs);
+
+    const Stats& stats();
+}
@@ -3,7 +3,6 @@
 #include <Wire.h>
 #include <cstring>
 #include <string>
-#include <cmath>   // isnan, NAN
 
 #include <AiEsp32RotaryEncoder.h>
 #include <Adafruit_GC9A01A.h>
@@ -14,59 +13,223 @@
 #include <BLEDevice.h>
 #include <BLEServer.h>
 #include <BLE2902.h>
+#include <esp_gap_ble_api.h>
 
 #include "AppConfig.h"
+#include "BandCanvas.h"
+#include "BinProto.h"
+#include "BleBatcher.h"
+#include "BleTxQueue.h"
+#include "CircleClip.h"
 #include "CircleText.h"
+#include "CstTouch.h"
+#include "EncoderSource.h"
+#include "FixedTextField.h"
+#include "FrameScheduler.h"
+#include "InputQueue.h"
+#include "KeySampler.h"
+#include "Mailbox.h"
+#include "Mux.h"
+#include "OledPages.h"
+#include "PropStore.h"
+#include "RxParser.h"
+#include "RxSplit.h"
+#include "SpscRing.h"
+#include "TouchTrail.h"
+#include "Wake.h"
 
 // ===================== BLE =====================
 BLECharacteristic* g_char = nullptr;
 volatile bool g_deviceConnected = false;
 
-static void tftStatusCircle(const char* s);
+static void renderStatus(const char* s);
 static bool logDirty = true;
 
-// Android -> ESP RX (handled in loop to avoid heavy work inside BLE callbacks)
-static volatile bool g_rxPending = false;
-static char g_rxMsg[LogCfg::LEN] = {0};
+// OLED is drawn from loop(); every producer of OLED-visible state invalidates it
+static FrameScheduler oledFrames(FrameCfg::OLED_FPS);
+
+// set from BLE callbacks, picked up by loop()
+static volatile bool g_bleStateChanged = false;     // connected / disconnected
+static volatile bool g_bleLinkChanged = false;      // MTU of the current link
+static volatile uint32_t g_bleLinkGen = 0;          // bumped on every disconnect
+
+// wire format, chosen by the phone after CAP?; back to text on every connect
+enum class BleMode : uint8_t { Text, Bin };
+static volatile BleMode g_bleMode = BleMode::Text;
+static uint8_t g_bleSeq = 0;
+
+// link parameters from the BLE task, applied to the batcher in loop()
+static volatile uint16_t g_peerMtu = BleBatcher::DEFAULT_MTU;
+static volatile uint16_t g_connIntervalMs = 0;
+static volatile uint16_t g_connId = 0;
+static volatile uint32_t g_notifyFailed = 0;
+
+// Android -> ESP RX (handled in loop to avoid heavy work inside BLE callbacks).
+// One slot per write; producer is the BLE task, consumer loop().
+struct RxSlot {
+    uint16_t len;
+    char data[RxCfg::SLOT_LEN];
+};
+static SpscRing<RxSlot, RxCfg::SLOTS> g_rxRing;
+static volatile uint32_t g_rxWrites = 0;
+static volatile uint32_t g_rxOverflow = 0;   // ring full, write lost
+static volatile uint32_t g_rxTooLong = 0;    // line longer than a slot, tail cut
+static volatile uint32_t g_rxHighWater = 0;
+static uint32_t g_rxDeferred = 0;            // line held back, no room for a reply
 
 class RxCallbacks : public BLECharacteristicCallbacks {
 public:
+    void onStatus(BLECharacteristic* ch, Status s, uint32_t code) override {
+        (void)ch;
+        (void)code;
+        if (s != SUCCESS_NOTIFY && s != SUCCESS_INDICATE) g_notifyFailed = g_notifyFailed + 1;
+    }
+
     void onWrite(BLECharacteristic* ch) override {
         std::string v = ch->getValue();
         if (v.empty()) return;
+        g_rxWrites = g_rxWrites + 1;
+
+        // a write up to the MTU may take several slots, split between lines
+        static RxSlot slot;   // BLE task only
+        const char* p = v.data();
+        size_t left = v.size();
+        while (left) {
+            RxSplit::Piece pc = RxSplit::next(p, left, RxCfg::SLOT_LEN);
+            if (pc.cut) g_rxTooLong = g_rxTooLong + 1;
+
+            slot.len = (uint16_t)pc.len;
+            std::memcpy(slot.data, p, slot.len);
+            if (!g_rxRing.push(slot)) {
+                g_rxOverflow = g_rxOverflow + 1;
+                break;
+            }
+            p += pc.next;
+            left -= pc.next;
+        }
 
-        size_t n = v.size();
-        if (n >= LogCfg::LEN) n = LogCfg::LEN - 1;
-        std::memcpy((void*)g_rxMsg, v.data(), n);
-        g_rxMsg[n] = '\0';
-        g_rxPending = true;
+        uint32_t n = g_rxRing.size();
+        if (n > g_rxHighWater) g_rxHighWater = n;
+        Wake::set(Wake::RX);
     }
 };
 
 class MyServerCallbacks : public BLEServerCallbacks {
-    void onConnect(BLEServer* pServer) override {
+    // The library calls the plain onConnect() first; only this overload has
+    // the link parameters, so loop() is told about the link from here.
+    void onConnect(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) override {
         (void)pServer;
+        g_peerMtu = BleBatcher::DEFAULT_MTU;
+        g_connId = param->connect.conn_id;
+        g_connIntervalMs = (uint16_t)(param->connect.conn_params.interval * 5 / 4);   // 1.25 ms units
+        g_bleMode = BleMode::Text;
         g_deviceConnected = true;
-        logDirty = true;
-        tftStatusCircle("BLE:ON");
+        g_bleStateChanged = true;
+        Wake::set(Wake::BLE);
+    }
+    void onMtuChanged(BLEServer* pServer, esp_ble_gatts_cb_param_t* param) override {
+        (void)pServer;
+        g_peerMtu = param->mtu.mtu;
+        g_bleLinkChanged = true;
+        Wake::set(Wake::BLE);
     }
     void onDisconnect(BLEServer* pServer) override {
         g_deviceConnected = false;
-        logDirty = true;
-        tftStatusCircle("BLE:OFF");
+        g_bleMode = BleMode::Text;
+        g_bleLinkGen++;
+        g_bleStateChanged = true;
+        Wake::set(Wake::BLE);
         pServer->getAdvertising()->start();
     }
 };
 
-static inline void bleSend(const char* msg) {
-    if (g_deviceConnected && g_char) {
-        g_char->setValue((uint8_t*)msg, strlen(msg));
-        g_char->notify();
+static bool bleNotify(const uint8_t* data, size_t n) {
+    if (!g_deviceConnected || !g_char) return false;
+    g_char->setValue((uint8_t*)data, n);
+    g_char->notify();
+    return true;
+}
+
+static BleBatcher bleTx(bleNotify);
+static BleTxQueue bleTxQueue;
+static uint32_t bleTxStalls = 0;   // records waiting, no link credits
+
+static inline uint8_t bleFraming() {
+    return (uint8_t)((g_bleMode == BleMode::Bin) ? BleBatcher::Framing::LengthPrefix
+                                                 : BleBatcher::Framing::Newline);
+}
+
+// false: control queue full, the caller keeps the event (or nothing to send to)
+static inline bool bleSendRaw(const uint8_t* data, size_t n, BleTxQueue::Class cls) {
+    if (!g_deviceConnected || !g_char) return false;
+    return bleTxQueue.push(cls, bleFraming(), data, n);
+}
+
+// queue -> batcher while the controller has buffers for this link
+static void bleTxDrain() {
+    if (!g_deviceConnected) return;
+
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    BleTxQueue::Record r;
+    while (esp_ble_get_cur_sendable_packets_num(g_connId) > 0) {
+        if (!bleTxQueue.pop(r)) {
+            bleTx.poll(now);
+            return;
+        }
+        bleTx.setFraming((BleBatcher::Framing)r.framing);
+        bleTx.add(r.data, r.len, now);
+    }
+    if (!bleTxQueue.empty() || bleTx.pending()) bleTxStalls++;
+}
+
+// called from loop() when the BLE callbacks flagged a change; on disconnect
+// everything still queued is dropped here, before anything new is produced
+static void bleTxApplyLink() {
+    // records of a link that went away, even if a new one is already up
+    static uint32_t gen = 0;
+    if (gen != g_bleLinkGen) {
+        gen = g_bleLinkGen;
+        bleTxQueue.clear();
+        bleTx.reset();
+    }
+    if (!g_deviceConnected) {
+        bleTx.setMtu(BleBatcher::DEFAULT_MTU);
+        return;
     }
+    bleTx.setMtu(g_peerMtu);
+    uint32_t ms = constrain((uint32_t)g_connIntervalMs, (uint32_t)BleTxCfg::FLUSH_MIN_MS,
+                            (uint32_t)BleTxCfg::FLUSH_MAX_MS);
+    bleTx.setFlushUs(ms * 1000);
+}
+
+// no room for another control record: hold input and commands back
+static inline bool bleTxBlocked() {
+    return g_deviceConnected && !bleTxQueue.room(BleTxQueue::Control);
+}
+
+static inline bool bleSend(const char* msg, BleTxQueue::Class cls = BleTxQueue::Control) {
+    return bleSendRaw((const uint8_t*)msg, strlen(msg), cls);
+}
+
+static bool bleSendFrame(uint8_t op, const int32_t* args, uint8_t argc, BleTxQueue::Class cls) {
+    uint8_t f[BinProto::MAX_FRAME];
+    size_t n = BinProto::encode(f, sizeof(f), op, g_bleSeq++, args, argc);
+    return n && bleSendRaw(f, n, cls);
+}
+
+// text that has no opcode of its own, in the current framing: status echoes
+// (telemetry, droppable) and command replies (control)
+static bool bleSendText(const char* msg, BleTxQueue::Class cls = BleTxQueue::Telemetry) {
+    if (g_bleMode == BleMode::Text) return bleSend(msg, cls);
+
+    uint8_t f[LogCfg::LEN + 2];
+    size_t n = BinProto::encodeText(f, sizeof(f), g_bleSeq++, msg, strlen(msg));
+    return n && bleSendRaw(f, n, cls);
 }
 
 static void bleInit() {
     BLEDevice::init(Cfg::BLE_NAME);
+    BLEDevice::setMTU(BleTxCfg::LOCAL_MTU);
 
     BLEServer* server = BLEDevice::createServer();
     server->setCallbacks(new MyServerCallbacks());
@@ -101,32 +264,37 @@ CST816S touch(Pins::I2C_SDA, Pins::I2C_SCL, Pins::TP_RST, Pins::TP_INT);
 
 static bool oledOk = false;
 static uint8_t oledAddr = 0x3C;
-Adafruit_SSD1306 oled(OledCfg::W, OledCfg::H, &Wire, -1);
-
-// ===================== 4067 MUX helpers =====================
-static inline void muxSelect(uint8_t ch) {
-    digitalWrite(Pins::MUX_S0, (ch >> 0) & 1);
-    digitalWrite(Pins::MUX_S1, (ch >> 1) & 1);
-    digitalWrite(Pins::MUX_S2, (ch >> 2) & 1);
-    digitalWrite(Pins::MUX_S3, (ch >> 3) & 1);
-}
+Adafruit_SSD1306 oled(OledCfg::W, OledCfg::H, &Wire, -1, OledCfg::I2C_HZ, OledCfg::I2C_HZ_AFTER);
+static OledPageFlusher oledPages;
 
-static inline bool readButtonPressedByIndex(uint8_t idx) {
-    uint8_t ch = BtnCfg::BTN_FIRST_CH + idx;
-    muxSelect(ch);
-    delayMicroseconds(8);
-    return digitalRead(Pins::MUX_SIG) == LOW;
-}
+// data bytes per transmission, chosen the same way as the Adafruit driver
+#if defined(I2C_BUFFER_LENGTH)
+static constexpr uint8_t OLED_DATA_CHUNK = ((I2C_BUFFER_LENGTH > 256) ? 256 : I2C_BUFFER_LENGTH) - 1;
+#else
+static constexpr uint8_t OLED_DATA_CHUNK = 31;
+#endif
 
 // ===================== Encoders =====================
 AiEsp32RotaryEncoder enc1(Pins::ENC1_A, Pins::ENC1_B, -1, -1, 4);
 AiEsp32RotaryEncoder enc2(Pins::ENC2_A, Pins::ENC2_B, -1, -1, 4);
 
-static uint32_t encKeyDownMs[2] = {0, 0};
-static bool encKeyWasDown[2] = {false, false};
+void IRAM_ATTR enc1ISR() { enc1.readEncoder_ISR(); Wake::setFromISR(Wake::ENCODER); }
+void IRAM_ATTR enc2ISR() { enc2.readEncoder_ISR(); Wake::setFromISR(Wake::ENCODER); }
 
-void IRAM_ATTR enc1ISR() { enc1.readEncoder_ISR(); }
-void IRAM_ATTR enc2ISR() { enc2.readEncoder_ISR(); }
+static PcntEncoder enc1Pcnt(PCNT_UNIT_0, Pins::ENC1_A, Pins::ENC1_B, EncCfg::COUNTS_PER_DETENT,
+                            EncCfg::PCNT_FILTER_APB);
+static PcntEncoder enc2Pcnt(PCNT_UNIT_1, Pins::ENC2_A, Pins::ENC2_B, EncCfg::COUNTS_PER_DETENT,
+                            EncCfg::PCNT_FILTER_APB);
+static LibEncoder enc1Lib(enc1, Pins::ENC1_A, Pins::ENC1_B, enc1ISR);
+static LibEncoder enc2Lib(enc2, Pins::ENC2_A, Pins::ENC2_B, enc2ISR);
+
+static EncoderSource* encoders[2] = {&enc1Lib, &enc2Lib};
+
+static EncoderSource* encoderBegin(PcntEncoder& pcnt, LibEncoder& lib) {
+    if (EncCfg::USE_PCNT && pcnt.begin()) return &pcnt;
+    lib.begin();
+    return &lib;
+}
 
 // ===================== Simple UI helpers =====================
 static void tftText(int16_t x, int16_t y, uint8_t size, uint16_t color, const char* s) {
@@ -136,168 +304,511 @@ static void tftText(int16_t x, int16_t y, uint8_t size, uint16_t color, const ch
     tft.print(s);
 }
 
-static void tftStatusCircle(const char* s) {
-    auto cfg = TftTextCfg::Status();
-    tft.fillRect(0, cfg.topY, 240, (cfg.bottomY - cfg.topY + 1), GC9A01A_BLACK);
-    tft.setTextWrap(false);
-    CircleText::drawWithConfig(tft, cfg, s, CircleTextPos::Top);
+// Text zones are rendered into an off-screen band and sent as one window.
+// Without the band they're drawn straight to the panel after a clipped clear.
+static uint16_t tftBandBuf[TftCfg::BAND_BUF_PX];
+static BandCanvas tftBand(TftCfg::W, TftCfg::H, tftBandBuf, TftCfg::BAND_BUF_PX);
+
+// what the last status draw touched; only that gets rewritten next time
+static CircleTextBox tftStatusBox;
+
+static uint32_t tftZoneUpdates = 0;
+static uint32_t tftZonePixels = 0;
+static uint32_t tftZoneWindows = 0;
+
+// band window = zone rows x widest chord inside them
+static bool tftBandFor(const CircleTextConfig& cfg) {
+    if (!TftCfg::USE_BAND_CANVAS) return false;
+
+    const CircleGeometry& g = CircleText::geometryFor(cfg);
+    int16_t half = -1;
+    for (int16_t y = cfg.topY; y <= cfg.bottomY; y++) {
+        int16_t h = g.halfWidth(y);
+        if (h > half) half = h;
+    }
+    if (half < 0) return false;
+    return tftBand.setWindow(g.cx() - half, cfg.topY, 2 * half + 1, cfg.bottomY - cfg.topY + 1);
 }
 
-static void tftBottomCircleXY(int16_t x, int16_t y) {
-    auto cfg = TftTextCfg::Bottom();
-    tft.fillRect(0, cfg.topY, 240, (cfg.bottomY - cfg.topY + 1), GC9A01A_BLACK);
+static void tftZoneText(const CircleTextConfig& cfg, CircleTextBox& last, const char* s, CircleTextPos pos) {
+    tftZoneUpdates++;
+
+    if (tftBandFor(cfg)) {
+        tftBand.fillScreen(GC9A01A_BLACK);
+        CircleTextBox box = CircleText::drawWithConfig(tftBand, cfg, s, pos);
 
-    char buf[64];
-    snprintf(buf, sizeof(buf), "X:%d  Y:%d", x, y);
+        CircleTextBox dirty = last;
+        dirty.merge(box);
+        last = box;
+        if (dirty.empty()) return;
 
+        tftZonePixels += tftBand.push(tft, dirty.x0, dirty.y0, dirty.x1 - dirty.x0 + 1, dirty.y1 - dirty.y0 + 1);
+        tftZoneWindows++;
+        return;
+    }
+
+    if (!last.empty()) {
+        ClipStats st = CircleClip::fillRows(tft, CircleText::geometryFor(cfg), last.y0, last.y1, last.x0, last.x1, GC9A01A_BLACK);
+        tftZonePixels += st.pixels;
+        tftZoneWindows += st.windows;
+    }
     tft.setTextWrap(false);
-    CircleText::drawWithConfig(tft, cfg, buf, CircleTextPos::Bottom);
+    last = CircleText::drawWithConfig(tft, cfg, s, pos);
+}
+
+static void tftStatusCircle(const char* s) {
+    tftZoneText(TftTextCfg::Status(), tftStatusBox, s, CircleTextPos::Top);
+}
+
+// touch readout: fixed cells, only the digits that changed are rewritten
+static FixedTextField tftXYField(TouchCfg::XY_FIELD_X, TouchCfg::XY_FIELD_Y, TouchCfg::XY_SIZE,
+                                 GC9A01A_WHITE, GC9A01A_BLACK);
+
+static void tftBottomXY(int16_t x, int16_t y) {
+    char buf[TouchCfg::XY_CHARS + 1];
+    snprintf(buf, sizeof(buf), "X:%3d Y:%3d", x, y);
+    tftXYField.update(tftBand, tft, buf);
+}
+
+// ===================== Render task =====================
+// loop() only posts; all TFT drawing after setup() happens on the other
+// core. Single producer (loop), single consumer (renderTask).
+// Status and XY readout only ever need their latest value, so they go
+// through overwrite-latest mailboxes and can't be lost to a full queue.
+// Touch points are queued; a lifted finger bumps the stroke id instead of
+// queueing a marker, so the end of a stroke is never dropped either.
+struct RenderDot {
+    int16_t x, y;
+    uint32_t stroke;
+};
+
+struct RenderText {
+    char text[LogCfg::LEN];
+};
+
+struct RenderXY {
+    int16_t x, y;
+};
+
+static SpscRing<RenderDot, RenderCfg::QUEUE_LEN> renderDots;
+static Mailbox<RenderText> renderStatusBox;
+static Mailbox<RenderXY> renderXYBox;
+static std::atomic<uint32_t> renderStroke{0};
+static TaskHandle_t renderTaskHandle = nullptr;
+
+static uint32_t renderQueued = 0;
+static uint32_t renderDropped = 0;      // touch points, dot queue full
+static uint32_t renderCoalesced = 0;    // superseded before drawn, consumer side
+static uint32_t renderSegments = 0;     // touch trail segments drawn
+
+static void renderWake() {
+    renderQueued++;
+    if (renderTaskHandle) xTaskNotifyGive(renderTaskHandle);
+}
+
+static void renderStatus(const char* s) {
+    RenderText t;
+    strncpy(t.text, s, sizeof(t.text) - 1);
+    t.text[sizeof(t.text) - 1] = '\0';
+    renderStatusBox.post(t);
+    renderWake();
+}
+
+static void renderTouch(int16_t x, int16_t y) {
+    RenderDot d{x, y, renderStroke.load(std::memory_order_relaxed)};
+    if (!renderDots.push(d)) renderDropped++;
+
+    renderXYBox.post({x, y});
+    renderWake();
+}
+
+static void renderTouchUp() {
+    renderStroke.fetch_add(1, std::memory_order_release);
+    renderWake();
+}
+
+// owned by the render task
+static FrameScheduler tftFrames(FrameCfg::TFT_FPS);
+
+static void renderTask(void*) {
+    RenderDot d;
+    RenderText status;
+    RenderXY xy{0, 0};
+    bool haveStatus = false, haveXY = false;
+    uint32_t stroke = 0;
+    TouchTrail trail;
+
+    auto endStroke = [&](uint32_t next) {
+        // points already queued still belong to the old stroke
+        if (!trail.empty()) {
+            renderSegments += trail.draw(tft, TouchCfg::TRAIL_RADIUS, GC9A01A_GREEN);
+        }
+        trail.breakStroke();
+        stroke = next;
+    };
+
+    for (;;) {
+        TickType_t wait = portMAX_DELAY;
+        if (tftFrames.pending()) {
+            wait = pdMS_TO_TICKS((tftFrames.untilDueUs(micros()) + 999) / 1000);
+        }
+        ulTaskNotifyTake(pdTRUE, wait);
+
+        // read before the dots: every point of a stroke that ended by now is queued
+        uint32_t lifted = renderStroke.load(std::memory_order_acquire);
+
+        while (renderDots.pop(d)) {
+            tftFrames.invalidate();
+            if (d.stroke != stroke) endStroke(d.stroke);
+            if (!trail.add(d.x, d.y)) renderCoalesced++;
+        }
+        // a dot pushed after the load may already have moved us past it
+        if ((int32_t)(lifted - stroke) > 0) {
+            tftFrames.invalidate();
+            endStroke(lifted);
+        }
+
+        // only the latest status / XY readout survives until the next frame
+        if (renderStatusBox.take(status)) {
+            tftFrames.invalidate();
+            if (haveStatus) renderCoalesced++;
+            haveStatus = true;
+        }
+        if (renderXYBox.take(xy)) {
+            tftFrames.invalidate();
+            if (haveXY) renderCoalesced++;
+            haveXY = true;
+        }
+
+        if (!tftFrames.due(micros())) continue;
+        tftFrames.frameStart(micros());
+
+        renderSegments += trail.draw(tft, TouchCfg::TRAIL_RADIUS, GC9A01A_GREEN);
+        if (haveStatus) tftStatusCircle(status.text);
+        if (haveXY) tftBottomXY(xy.x, xy.y);
+        haveStatus = haveXY = false;
+
+        tftFrames.frameEnd(micros());
+    }
+}
+
+static void renderBegin() {
+    xTaskCreatePinnedToCore(renderTask, "render", RenderCfg::TASK_STACK, nullptr,
+                            RenderCfg::TASK_PRIO, &renderTaskHandle, RenderCfg::TASK_CORE);
 }
 
 // ===================== Logger =====================
 static char logBuf[LogCfg::LINES][LogCfg::LEN];
 static uint8_t logHead = 0;
 
-static int g_rearDefrost = -1;     // -1 unknown, 0 off, 1 on
-static int g_electricDefrost = -1; // -1 unknown, 0 off, 1 on
-
-static int  g_fanArea = -1;
-static char g_fanLevel[12] = "?";  // OFF/AUTO/L1..L9/UNK
+// vehicle state reported by the phone, see PropCfg
+static PropStore g_props;
 
-static float g_tempMain = NAN;     // area=1
-static float g_tempPass = NAN;     // area=4
-
-static void logPush(const char* msg) {
+// OLED log, Serial and TFT status; BLE is up to the caller
+static void logLocal(const char* msg) {
     strncpy(logBuf[logHead], msg, LogCfg::LEN - 1);
     logBuf[logHead][LogCfg::LEN - 1] = '\0';
     logHead = (logHead + 1) % LogCfg::LINES;
     logDirty = true;
+    oledFrames.invalidate();
 
     Serial.println(msg);
-    tftStatusCircle(msg);
-    bleSend(msg);
+    renderStatus(msg);
 }
 
-static void processRx(const char* s) {
-    // FB:REAR:1
-    if (strncmp(s, "FB:REAR:", 8) == 0) {
-        int v = atoi(s + 8);
-        g_rearDefrost = v;
-        char b[LogCfg::LEN];
-        snprintf(b, sizeof(b), "REAR_DEF:%s", (v == 1 ? "ON" : "OFF"));
-        logPush(b);
-        return;
-    }
+static void logPush(const char* msg) {
+    logLocal(msg);
+    bleSendText(msg);
+}
 
-    // FB:ELECTRIC:0
-    if (strncmp(s, "FB:ELECTRIC:", 12) == 0) {
-        int v = atoi(s + 12);
-        g_electricDefrost = v;
-        char b[LogCfg::LEN];
-        snprintf(b, sizeof(b), "E_DEF:%s", (v == 1 ? "ON" : "OFF"));
-        logPush(b);
-        return;
-    }
+// ===================== RX commands =====================
+// Replies are control records; drainRx() only dispatches a line while the
+// control queue has room, so a reply is never dropped.
+
+// CAP?  -> CAP:<version>:TEXT,BIN
+static bool rxCap(const RxParser::Args& a) {
+    (void)a;
+    char b[LogCfg::LEN];
+    snprintf(b, sizeof(b), "CAP:%u:TEXT,BIN", (unsigned)BinProto::VERSION);
+    logLocal(b);
+    bleSendText(b, BleTxQueue::Control);
+    return true;
+}
 
-    // FB:FAN:<area>:<level>
-    // example: FB:FAN:8:L3
-    if (strncmp(s, "FB:FAN:", 7) == 0) {
-        const char* p = s + 7;
-        g_fanArea = atoi(p);
+// MODE:BIN / MODE:TEXT, acknowledged in the mode being left: a plain line
+// from text mode, an OP_TEXT frame from binary mode
+static bool rxMode(const RxParser::Args& a) {
+    bool bin = a.f[0].tok.is("BIN");
+    if (!bin && !a.f[0].tok.is("TEXT")) return false;
+
+    const char* ack = bin ? "MODE:BIN" : "MODE:TEXT";
+    logLocal(ack);
+    // queued records keep the framing they were queued with
+    bleSendText(ack, BleTxQueue::Control);
+    g_bleMode = bin ? BleMode::Bin : BleMode::Text;
+    g_bleSeq = 0;
+    return true;
+}
 
-        const char* c1 = strchr(p, ':');
-        if (c1 && *(c1 + 1)) {
-            strncpy(g_fanLevel, c1 + 1, sizeof(g_fanLevel) - 1);
-            g_fanLevel[sizeof(g_fanLevel) - 1] = '\0';
-        } else {
-            strncpy(g_fanLevel, "?", sizeof(g_fanLevel));
-            g_fanLevel[sizeof(g_fanLevel) - 1] = '\0';
-        }
+// FB:REAR:1
+static bool rxRear(const RxParser::Args& a) {
+    int v = (int)a.f[0].i;
+    g_props.setInt(PropCfg::FB_REAR_DEFROST, 0, v);
+    char b[LogCfg::LEN];
+    snprintf(b, sizeof(b), "REAR_DEF:%s", (v == 1 ? "ON" : "OFF"));
+    logPush(b);
+    return true;
+}
+
+// FB:ELECTRIC:0
+static bool rxElectric(const RxParser::Args& a) {
+    int v = (int)a.f[0].i;
+    g_props.setInt(PropCfg::FB_ELECTRIC_DEFROST, 0, v);
+    char b[LogCfg::LEN];
+    snprintf(b, sizeof(b), "E_DEF:%s", (v == 1 ? "ON" : "OFF"));
+    logPush(b);
+    return true;
+}
+
+// FB:FAN:<area>:<level>
+// example: FB:FAN:8:L3
+static bool rxFan(const RxParser::Args& a) {
+    int32_t area = a.f[0].i;
+    const RxParser::Token& t = a.f[1].tok;
+
+    // level first, so a watcher that sees the new area also finds its level
+    PropStore::Ref r = t.n ? g_props.setText(PropCfg::FB_FAN_LEVEL, area, t.p, t.n)
+                           : g_props.setText(PropCfg::FB_FAN_LEVEL, area, "?", 1);
+    g_props.setInt(PropCfg::FB_FAN_AREA, 0, area);
+
+    const PropStore::Value* v = g_props.get(r);
+    char b[LogCfg::LEN];
+    snprintf(b, sizeof(b), "FAN:%ld:%s", (long)area, v ? v->text : "?");
+    logPush(b);
+    return true;
+}
+
+// GIB:FLOAT:<id>:<area>:<value>
+// example: GIB:FLOAT:268828928:1:22.5
+// Every id is stored; the OLED header watches the ones it shows.
+static bool rxGibFloat(const RxParser::Args& a) {
+    int32_t id = a.f[0].i;
+    int32_t area = a.f[1].i;
+    int32_t v = a.f[2].i;   // RxParser::FIXED_SCALE units
+    char num[16];
+
+    if (id < 0) return false;
+    g_props.setFixed((uint32_t)id, area, v);
 
+    if ((uint32_t)id == PropCfg::HVAC_FUNC_TEMP) {
+        RxParser::formatFixed(num, sizeof(num), v, 1);
         char b[LogCfg::LEN];
-        snprintf(b, sizeof(b), "FAN:%d:%s", g_fanArea, g_fanLevel);
+        snprintf(b, sizeof(b), "TEMP:%ld:%s", (long)area, num);
         logPush(b);
-        return;
+        return true;
     }
 
-    // GIB:FLOAT:<id>:<area>:<value>
-    // example: GIB:FLOAT:268828928:1:22.5
-    if (strncmp(s, "GIB:FLOAT:", 10) == 0) {
-        const char* p = s + 10;
+    RxParser::formatFixed(num, sizeof(num), v, 2);
+    char b[LogCfg::LEN];
+    snprintf(b, sizeof(b), "F:%ld:%ld:%s", (long)id, (long)area, num);
+    logPush(b);
+    return true;
+}
+
+// GIB:INT:<id>:<area>:<value>
+static bool rxGibInt(const RxParser::Args& a) {
+    int32_t id = a.f[0].i;
+    if (id < 0) return false;
+    g_props.setInt((uint32_t)id, a.f[1].i, a.f[2].i);
+
+    char b[LogCfg::LEN];
+    snprintf(b, sizeof(b), "I:%ld:%ld:%ld", (long)id, (long)a.f[1].i, (long)a.f[2].i);
+    logPush(b);
+    return true;
+}
+
+static bool rxFallback(const RxParser::Args& a) {
+    char buf[LogCfg::LEN];
+    snprintf(buf, sizeof(buf), "RX:%.*s", (int)a.lineLen, a.line);
+    logPush(buf);
+    return true;
+}
 
-        int id = atoi(p);
-        const char* c1 = strchr(p, ':');
-        if (!c1) goto fallback;
-        int area = atoi(c1 + 1);
+static const RxParser::Command kRxCommands[] = {
+    {"CAP?",         "",    rxCap},
+    {"MODE:",        "T",   rxMode},
+    {"FB:REAR:",     "I",   rxRear},
+    {"FB:ELECTRIC:", "I",   rxElectric},
+    {"FB:FAN:",      "It",  rxFan},
+    {"GIB:FLOAT:",   "IIF", rxGibFloat},
+    {"GIB:INT:",     "III", rxGibInt},
+};
 
-        const char* c2 = strchr(c1 + 1, ':');
-        if (!c2) goto fallback;
-        float v = (float)atof(c2 + 1);
+static RxParser::Dispatcher rxDispatch(kRxCommands,
+                                       sizeof(kRxCommands) / sizeof(kRxCommands[0]),
+                                       rxFallback);
 
-        if (id == 268828928) { // IHvac.HVAC_FUNC_TEMP
-            if (area == 1) g_tempMain = v;
-            else if (area == 4) g_tempPass = v;
+// everything that arrived since the last loop, one message per line
+static void drainRx() {
+    static RxSlot slot;
+    static uint16_t pos = 0;    // next unread byte of slot
 
-            char b[LogCfg::LEN];
-            snprintf(b, sizeof(b), "TEMP:%d:%.1f", area, v);
-            logPush(b);
+    for (;;) {
+        if (pos >= slot.len) {
+            if (!g_rxRing.pop(slot)) return;
+            pos = 0;
+        }
+        // a line may need a reply: leave it for a later pass rather than lose that
+        if (bleTxBlocked()) {
+            g_rxDeferred++;
             return;
         }
 
-        char b[LogCfg::LEN];
-        snprintf(b, sizeof(b), "F:%d:%d:%.2f", id, area, v);
-        logPush(b);
-        return;
+        const char* p = slot.data + pos;
+        const char* end = slot.data + slot.len;
+        const char* e = p;
+        while (e < end && *e != '\n' && *e != '\r') e++;
+        if (e > p) rxDispatch.dispatch(p, (size_t)(e - p));
+        pos = (uint16_t)(e - slot.data + 1);
     }
+}
 
-    fallback:
-    char buf[LogCfg::LEN];
-    snprintf(buf, sizeof(buf), "RX:%s", s);
-    logPush(buf);
+// Header fields, each redrawn only when its value changes. BLE state is
+// local; the rest comes from g_props through the OLED's subscription.
+struct OledHeaderDirty {
+    bool ble;
+    bool defrost;   // R: E:
+    bool fan;       // F:area:level
+    bool temp;      // T1: T4:
+    bool any() const { return ble || defrost || fan || temp; }
+};
+static uint8_t oledSub = PropStore::MAX_SUBS;
+static bool oledHdrBle = false;
+static bool oledHdrValid = false;
+
+static void oledWatchProps() {
+    oledSub = g_props.subscribe();
+    g_props.watch(oledSub, PropCfg::FB_REAR_DEFROST);
+    g_props.watch(oledSub, PropCfg::FB_ELECTRIC_DEFROST);
+    g_props.watch(oledSub, PropCfg::FB_FAN_AREA);
+    g_props.watch(oledSub, PropCfg::FB_FAN_LEVEL);
+    g_props.watch(oledSub, PropCfg::HVAC_FUNC_TEMP, PropCfg::AREA_MAIN);
+    g_props.watch(oledSub, PropCfg::HVAC_FUNC_TEMP, PropCfg::AREA_PASS);
+}
+
+static bool takeProp(uint32_t id, int32_t area) {
+    return g_props.take(oledSub, g_props.find(id, area));
+}
+
+static OledHeaderDirty oledHeaderChanged() {
+    OledHeaderDirty d{};
+    bool ble = g_deviceConnected;
+    d.ble = !oledHdrValid || ble != oledHdrBle;
+    oledHdrBle = ble;
+
+    if (g_props.poll(oledSub) || !oledHdrValid) {
+        d.defrost = takeProp(PropCfg::FB_REAR_DEFROST, 0) |
+                    takeProp(PropCfg::FB_ELECTRIC_DEFROST, 0);
+
+        const PropStore::Value* fa = g_props.get(PropCfg::FB_FAN_AREA, 0);
+        d.fan = takeProp(PropCfg::FB_FAN_AREA, 0) |
+                (fa && takeProp(PropCfg::FB_FAN_LEVEL, fa->i));
+
+        d.temp = takeProp(PropCfg::HVAC_FUNC_TEMP, PropCfg::AREA_MAIN) |
+                 takeProp(PropCfg::HVAC_FUNC_TEMP, PropCfg::AREA_PASS);
+    }
+    if (!oledHdrValid) d.defrost = d.fan = d.temp = true;
+    oledHdrValid = true;
+    return d;
+}
+
+static void oledPrintFlag(uint32_t id) {
+    const PropStore::Value* v = g_props.get(id, 0);
+    oled.print(!v ? "?" : (v->i ? "1" : "0"));
+}
+
+static void oledPrintTemp(int32_t area) {
+    const PropStore::Value* v = g_props.get(PropCfg::HVAC_FUNC_TEMP, area);
+    if (!v || v->type != PropStore::Type::Fixed) {
+        oled.print("?");
+        return;
+    }
+    char num[16];
+    RxParser::formatFixed(num, sizeof(num), v->i, 1);
+    oled.print(num);
 }
 
 static void oledRender() {
-    if (!oledOk || !logDirty) return;
+    if (!oledOk) return;
+
+    uint32_t t0 = micros();
+    if (!oledFrames.due(t0)) {
+        // rest of a frame the last pass had no budget for
+        if (oledPages.pending()) oledPages.flush(oled.getBuffer(), Wire, OledCfg::FLUSH_BYTES);
+        return;
+    }
+    oledFrames.frameStart(t0);
+
+    OledHeaderDirty hdr = oledHeaderChanged();
 
-    oled.clearDisplay();
     oled.setTextSize(1);
     oled.setTextColor(SSD1306_WHITE);
 
     // line 0
-    oled.setCursor(0, 0);
-    oled.print("BLE:");
-    oled.print(g_deviceConnected ? "ON " : "OFF");
-
-    oled.setCursor(70, 0);
-    oled.print("R:");
-    oled.print(g_rearDefrost < 0 ? "?" : (g_rearDefrost ? "1" : "0"));
-    oled.print(" E:");
-    oled.print(g_electricDefrost < 0 ? "?" : (g_electricDefrost ? "1" : "0"));
-
-    // line 1
-    oled.setCursor(0, 8);
-    oled.print("F:");
-    if (g_fanArea < 0) oled.print("?:");
-    else { oled.print(g_fanArea); oled.print(":"); }
-    oled.print(g_fanLevel);
-
-    oled.setCursor(70, 8);
-    oled.print("T1:");
-    if (isnan(g_tempMain)) oled.print("?");
-    else oled.print(String(g_tempMain, 1));
-    oled.print(" T4:");
-    if (isnan(g_tempPass)) oled.print("?");
-    else oled.print(String(g_tempPass, 1));
-
-    // logs (start lower)
-    for (uint8_t i = 0; i < LogCfg::LINES; i++) {
-        uint8_t idx = (logHead + i) % LogCfg::LINES;
-        oled.setCursor(0, 16 + i * 8);
-        oled.print(logBuf[idx]);
-    }
-
-    oled.display();
+    if (hdr.ble) {
+        oled.fillRect(0, 0, 70, 8, SSD1306_BLACK);
+        oled.setCursor(0, 0);
+        oled.print("BLE:");
+        oled.print(oledHdrBle ? "ON " : "OFF");
+    }
+    if (hdr.defrost) {
+        oled.fillRect(70, 0, OledCfg::W - 70, 8, SSD1306_BLACK);
+        oled.setCursor(70, 0);
+        oled.print("R:");
+        oledPrintFlag(PropCfg::FB_REAR_DEFROST);
+        oled.print(" E:");
+        oledPrintFlag(PropCfg::FB_ELECTRIC_DEFROST);
+    }
+
+    // line 1; the fan field is cut to its 70 px so it can't spill into T1
+    if (hdr.fan) {
+        const PropStore::Value* fa = g_props.get(PropCfg::FB_FAN_AREA, 0);
+        const PropStore::Value* fl = fa ? g_props.get(PropCfg::FB_FAN_LEVEL, fa->i) : nullptr;
+        char f[12];
+        if (fa) snprintf(f, sizeof(f), "F:%ld:%s", (long)fa->i, fl ? fl->text : "?");
+        else snprintf(f, sizeof(f), "F:?:?");
+
+        oled.fillRect(0, 8, 70, 8, SSD1306_BLACK);
+        oled.setCursor(0, 8);
+        oled.print(f);
+    }
+    if (hdr.temp) {
+        oled.fillRect(70, 8, OledCfg::W - 70, 8, SSD1306_BLACK);
+        oled.setCursor(70, 8);
+        oled.print("T1:");
+        oledPrintTemp(PropCfg::AREA_MAIN);
+        oled.print(" T4:");
+        oledPrintTemp(PropCfg::AREA_PASS);
+    }
+
+    if (logDirty) {
+        oled.fillRect(0, OledCfg::HEADER_H, OledCfg::W, OledCfg::H - OledCfg::HEADER_H, SSD1306_BLACK);
+
+        for (uint8_t i = 0; i < LogCfg::LINES; i++) {
+            uint8_t idx = (logHead + i) % LogCfg::LINES;
+            oled.setCursor(0, OledCfg::HEADER_H + i * 8);
+            oled.print(logBuf[idx]);
+        }
+    }
+
+    // only pages/columns that differ from the panel go over I2C, and only
+    // as many as fit this pass; the rest follow on the next passes
+    if (hdr.any() || logDirty || oledPages.pending()) {
+        oledPages.flush(oled.getBuffer(), Wire, OledCfg::FLUSH_BYTES);
+    }
     logDirty = false;
+
+    oledFrames.frameEnd(micros());
 }
 
 // ===================== I2C scan + OLED detect =====================
@@ -320,111 +831,123 @@ static bool hasAddr(uint8_t a) {
     return false;
 }
 
-// ===================== Buttons debounce =====================
-static bool rawState[BtnCfg::BTN_COUNT];
-static bool stableState[BtnCfg::BTN_COUNT];
-static uint32_t lastChangeMs[BtnCfg::BTN_COUNT];
-static uint32_t btnDownMs[BtnCfg::BTN_COUNT];
-static bool btnWasDown[BtnCfg::BTN_COUNT];
+// ===================== Buttons =====================
+// Edges arrive debounced and timestamped from KeySampler; click / long /
+// double / repeat come from the BtnCfg::KEYS table.
+static KeyMachine<BtnCfg::BTN_COUNT> keyMachine(BtnCfg::KEYS);
 
-static void scanButtons() {
-    uint32_t now = millis();
-
-    for (uint8_t idx = 0; idx < BtnCfg::BTN_COUNT; idx++) {
-        // энкодерные кнопки отдельно
-        if (idx == BtnCfg::ENC1_KEY_IDX || idx == BtnCfg::ENC2_KEY_IDX) continue;
+static void onKeyEvent(uint8_t idx, KeyEvent ev, uint32_t tUs) {
+    if (idx == BtnCfg::ENC1_KEY_IDX || idx == BtnCfg::ENC2_KEY_IDX) {
+        InputQueue::push(InputEvent::EncKey, (idx == BtnCfg::ENC1_KEY_IDX) ? 1 : 2,
+                         ev == KeyEvent::Long, 0, tUs);
+        return;
+    }
+    InputQueue::push(InputEvent::Button, idx, (int16_t)ev, 0, tUs);
+}
 
-        bool r = readButtonPressedByIndex(idx);
+static void handleKeyEdges() {
+    KeyEdge e;
+    while (KeySampler::pop(e)) {
+        if (e.ch < BtnCfg::BTN_FIRST_CH) continue;
+        keyMachine.edge(e.ch - BtnCfg::BTN_FIRST_CH, e.down, e.tUs, onKeyEvent);
+    }
+    keyMachine.tick((uint32_t)esp_timer_get_time(), onKeyEvent);
+}
 
-        if (r != rawState[idx]) {
-            rawState[idx] = r;
-            lastChangeMs[idx] = now;
-        }
+// ===================== Encoders handling =====================
+// Detents are summed per encoder and sent once the coalescing window closes.
+// A direction change flushes first, so opposite turns never cancel out.
+struct EncAccum {
+    long last;
+    long pending;
+    uint32_t sinceMs;
+};
+static EncAccum encAcc[2];
 
-        if ((now - lastChangeMs[idx]) >= BtnCfg::DEBOUNCE_MS) {
-            if (stableState[idx] != rawState[idx]) {
-                bool prev = stableState[idx];
-                stableState[idx] = rawState[idx];
-
-                // DOWN
-                if (!prev && stableState[idx]) {
-                    btnWasDown[idx] = true;
-                    btnDownMs[idx] = now;
-                }
-
-                // UP
-                if (prev && !stableState[idx]) {
-                    if (btnWasDown[idx]) {
-                        btnWasDown[idx] = false;
-                        uint32_t dur = now - btnDownMs[idx];
-                        bool isLong = (dur >= BtnCfg::LONG_MS);
-
-                        logPush(isLong ? Evt::btnLongByIdx(idx)
-                                       : Evt::btnClickByIdx(idx));
-                    }
-                }
-            }
-        }
+static long encAccel(long d) {
+    long steps = (d < 0) ? -d : d;
+    uint8_t mul = 1;
+    for (const auto& p : EncCfg::ACCEL_CURVE) {
+        if (steps >= p.steps) mul = p.mul;
     }
+    return d * mul;
 }
 
-// ===================== Encoders handling =====================
-static long enc1Last = 0;
-static long enc2Last = 0;
+static void encFlush(uint8_t i) {
+    long d = encAcc[i].pending;
+    if (d == 0) return;
+    encAcc[i].pending = 0;
+
+    if (EncCfg::ACCEL[i]) d = encAccel(d);
+    d = constrain(d, -32767L, 32767L);
+    InputQueue::push(InputEvent::Encoder, i + 1, (int16_t)d);
+}
 
 static void handleEncoders() {
-    long p1 = enc1.readEncoder();
-    long d1 = p1 - enc1Last;
-    if (d1 != 0) {
-        enc1Last = p1;
-        logPush(Evt::encStep(1, d1));
-    }
-
-    long p2 = enc2.readEncoder();
-    long d2 = p2 - enc2Last;
-    if (d2 != 0) {
-        enc2Last = p2;
-        logPush(Evt::encStep(2, d2));
-    }
-}
-
-static void handleEncoderKeysFromMux() {
-    bool k1 = readButtonPressedByIndex(BtnCfg::ENC1_KEY_IDX);
-    bool k2 = readButtonPressedByIndex(BtnCfg::ENC2_KEY_IDX);
-    bool keys[2] = {k1, k2};
-
-    for (int i = 0; i < 2; i++) {
-        if (keys[i] && !encKeyWasDown[i]) {
-            encKeyWasDown[i] = true;
-            encKeyDownMs[i] = millis();
-        } else if (!keys[i] && encKeyWasDown[i]) {
-            encKeyWasDown[i] = false;
-            uint32_t dur = millis() - encKeyDownMs[i];
-            bool isLong = (dur >= EncCfg::KEY_LONG_MS);
-            logPush(Evt::encKey((i == 0) ? 1 : 2, isLong));
+    uint32_t now = millis();
+
+    for (uint8_t i = 0; i < 2; i++) {
+        EncAccum& a = encAcc[i];
+        long p = encoders[i]->read();
+        long d = p - a.last;
+
+        if (d != 0) {
+            a.last = p;
+            if (a.pending != 0 && ((a.pending > 0) != (d > 0))) encFlush(i);
+            if (a.pending == 0) a.sinceMs = now;
+            a.pending += d;
         }
+
+        if (a.pending != 0 && (now - a.sinceMs) >= EncCfg::COALESCE_MS[i]) encFlush(i);
     }
 }
 
+// ms until the earliest pending encoder delta is due, UINT32_MAX when none
+static uint32_t encUntilFlushMs(uint32_t now) {
+    uint32_t t = UINT32_MAX;
+    for (uint8_t i = 0; i < 2; i++) {
+        const EncAccum& a = encAcc[i];
+        if (a.pending == 0) continue;
+        uint32_t age = now - a.sinceMs;
+        uint32_t left = (age >= EncCfg::COALESCE_MS[i]) ? 0 : EncCfg::COALESCE_MS[i] - age;
+        if (left < t) t = left;
+    }
+    return t;
+}
+
 // ===================== Touch =====================
+static void IRAM_ATTR touchWake() { Wake::setFromISR(Wake::TOUCH); }
+
 static bool touchDown = false;
 static uint32_t lastTouchEventMs = 0;
 static uint32_t lastTouchLogMs = 0;
 static int16_t lastTx = -1, lastTy = -1;
+static GestureRecognizer gestures(TouchCfg::GESTURE);
+
+static void pushGesture(const Gesture& g) {
+    if (g.kind == Gesture::None) return;
+    InputQueue::push(InputEvent::Gesture, g.kind, g.a, g.b);
+}
 
 static void handleTouch() {
     uint32_t now = millis();
 
     if (touchDown && (now - lastTouchEventMs) > TouchCfg::UP_TIMEOUT_MS) {
         touchDown = false;
-        logPush(Evt::TOUCH_UP);
+        renderTouchUp();
+        InputQueue::push(InputEvent::Touch, InputEvent::TouchUp);
+        // the stroke ended with the last report, not with the timeout
+        pushGesture(gestures.up(lastTouchEventMs));
         return;
     }
 
-    if (!touch.available()) return;
+    if (touchDown) pushGesture(gestures.tick(now));
 
-    int16_t x = (int16_t)touch.data.x;
-    int16_t y = (int16_t)touch.data.y;
+    TouchPoint tp;
+    if (!CstTouch::read(tp)) return;
+
+    int16_t x = tp.x;
+    int16_t y = tp.y;
     if (x == 0 && y == 0) return;
 
     x = constrain(x, 0, 239);
@@ -437,37 +960,290 @@ static void handleTouch() {
         lastTx = x;
         lastTy = y;
         lastTouchLogMs = 0;
-        logPush(Evt::TOUCH_DOWN);
+        InputQueue::push(InputEvent::Touch, InputEvent::TouchDown, x, y);
+        gestures.down(x, y, now);
+    } else {
+        gestures.move(x, y);
     }
 
+    // redraw rate is capped by the render task's frame scheduler
     static int16_t lastDrawX = -1, lastDrawY = -1;
-    static uint32_t lastDrawMs = 0;
-    if (now - lastDrawMs >= 40) {
-        if (x != lastDrawX || y != lastDrawY) {
-            lastDrawX = x;
-            lastDrawY = y;
-            lastDrawMs = now;
-            tft.fillCircle(x, y, 3, GC9A01A_GREEN);
-            tftBottomCircleXY(x, y);
-        }
+    if (x != lastDrawX || y != lastDrawY) {
+        lastDrawX = x;
+        lastDrawY = y;
+        renderTouch(x, y);
     }
 
+    if (!TouchCfg::RAW_XY) return;
+
     uint16_t dist = (uint16_t)abs(x - lastTx) + (uint16_t)abs(y - lastTy);
     if ((now - lastTouchLogMs) >= TouchCfg::LOG_MIN_MS && dist >= TouchCfg::LOG_MIN_DIST) {
         lastTouchLogMs = now;
         lastTx = x;
         lastTy = y;
 
-        char msg[LogCfg::LEN];
-        Evt::touchXY(msg, sizeof(msg), x, y);
-        logPush(msg);
+        InputQueue::push(InputEvent::Touch, InputEvent::TouchMove, x, y);
+    }
+}
+
+// ===================== Input dispatch =====================
+// Handlers only record events; text is built here, a bounded number per loop.
+static uint32_t inputLatencyMaxUs = 0;
+
+static const char* inputText(const InputEvent& e, char* buf, size_t n) {
+    switch (e.src) {
+        case InputEvent::Button:
+            switch ((KeyEvent)e.a) {
+                case KeyEvent::Long:   return Evt::btnLongByIdx(e.code);
+                case KeyEvent::Double: return Evt::btnDoubleByIdx(buf, n, e.code);
+                default:               return Evt::btnClickByIdx(e.code);
+            }
+        case InputEvent::EncKey:
+            return Evt::encKey(e.code, e.a != 0);
+        case InputEvent::Encoder:
+            return Evt::encDelta(buf, n, e.code, e.a);
+        case InputEvent::Touch:
+            if (e.code == InputEvent::TouchDown) return Evt::TOUCH_DOWN;
+            if (e.code == InputEvent::TouchUp) return Evt::TOUCH_UP;
+            Evt::touchXY(buf, n, e.a, e.b);
+            return buf;
+        case InputEvent::Gesture:
+            if (e.code == Gesture::Tap || e.code == Gesture::LongPress) {
+                Evt::gestureAt(buf, n, GestureRecognizer::name(e.code), e.a, e.b);
+            } else {
+                Evt::gesture(buf, n, GestureRecognizer::name(e.code), e.a);
+            }
+            return buf;
     }
+    return nullptr;
+}
+
+// raw touch coordinates may be dropped under congestion, everything else not
+static BleTxQueue::Class inputClass(const InputEvent& e) {
+    bool telemetry = (e.src == InputEvent::Touch && e.code == InputEvent::TouchMove);
+    return telemetry ? BleTxQueue::Telemetry : BleTxQueue::Control;
+}
+
+static void inputSendBin(const InputEvent& e) {
+    int32_t args[3];
+    uint8_t op;
+    uint8_t argc = 0;
+
+    switch (e.src) {
+        case InputEvent::Button:
+            op = ((KeyEvent)e.a == KeyEvent::Long)   ? BinProto::OP_BTN_LONG
+               : ((KeyEvent)e.a == KeyEvent::Double) ? BinProto::OP_BTN_DOUBLE
+                                                     : BinProto::OP_BTN_CLICK;
+            args[argc++] = e.code;
+            break;
+        case InputEvent::EncKey:
+            op = BinProto::OP_ENC_KEY;
+            args[argc++] = e.code;
+            args[argc++] = e.a;
+            break;
+        case InputEvent::Encoder:
+            op = BinProto::OP_ENC_DELTA;
+            args[argc++] = e.code;
+            args[argc++] = e.a;
+            break;
+        case InputEvent::Touch:
+            if (e.code == InputEvent::TouchUp) {
+                op = BinProto::OP_TOUCH_UP;
+                break;
+            }
+            op = (e.code == InputEvent::TouchDown) ? BinProto::OP_TOUCH_DOWN : BinProto::OP_TOUCH_XY;
+            args[argc++] = e.a;
+            args[argc++] = e.b;
+            break;
+        case InputEvent::Gesture:
+            op = BinProto::OP_GESTURE;
+            args[argc++] = e.code;
+            args[argc++] = e.a;
+            args[argc++] = e.b;
+            break;
+        default:
+            return;
+    }
+    bleSendFrame(op, args, argc, inputClass(e));
+}
+
+static void dispatchInput() {
+    InputEvent e;
+    char buf[LogCfg::LEN];
+
+    for (uint8_t i = 0; i < InputCfg::DISPATCH_PER_LOOP; i++) {
+        // backpressure: leave events in the input queue until BLE catches up
+        if (bleTxBlocked()) break;
+        if (!InputQueue::pop(e)) break;
+
+        uint32_t lat = (uint32_t)esp_timer_get_time() - e.tUs;
+        if (lat > inputLatencyMaxUs) inputLatencyMaxUs = lat;
+
+        const char* s = inputText(e, buf, sizeof(buf));
+        if (!s || !*s) continue;
+
+        logLocal(s);
+        if (g_bleMode == BleMode::Bin) inputSendBin(e);
+        else bleSend(s, inputClass(e));
+    }
+}
+
+// ===================== Loop pacing =====================
+// loop() blocks in Wake::wait() until an input/BLE bit or its next deadline.
+// Right after input it polls fast; PCNT encoders and the key/gesture timers
+// have no wake bit of their own.
+static uint32_t lastActivityMs = 0;
+static uint32_t lastInputPushed = 0;
+
+static uint32_t loopTimeoutMs(uint32_t now) {
+    // events held back by a full BLE queue wait for credits like the queue does
+    if (InputQueue::size() > 0) return bleTxBlocked() ? LoopCfg::ACTIVE_POLL_MS : 0;
+
+    bool active = touchDown || KeySampler::state() != 0 ||
+                  (now - lastActivityMs) < LoopCfg::ACTIVE_HOLD_MS;
+    uint32_t t = active ? LoopCfg::ACTIVE_POLL_MS : LoopCfg::IDLE_POLL_MS;
+
+    if (oledFrames.pending()) {
+        uint32_t due = (oledFrames.untilDueUs(micros()) + 999) / 1000;
+        if (due < t) t = due;
+    }
+    uint32_t enc = encUntilFlushMs(now);
+    if (enc < t) t = enc;
+    if (oledPages.pending() && LoopCfg::ACTIVE_POLL_MS < t) {
+        t = LoopCfg::ACTIVE_POLL_MS;   // rest of an OLED frame to send
+    }
+    if (g_deviceConnected && !bleTxQueue.empty() && LoopCfg::ACTIVE_POLL_MS < t) {
+        t = LoopCfg::ACTIVE_POLL_MS;   // waiting for link credits
+    }
+    if (bleTx.pending()) {
+        uint32_t due = (bleTx.untilDueUs((uint32_t)esp_timer_get_time()) + 999) / 1000;
+        if (due < t) t = due;
+    }
+    return t;
+}
+
+// ===================== Diagnostics =====================
+static void diagReport() {
+    if (!DiagCfg::ENABLED) return;
+
+    static uint32_t lastMs = 0;
+    uint32_t now = millis();
+    if (now - lastMs < DiagCfg::REPORT_MS) return;
+    lastMs = now;
+
+    const auto& ct = CircleText::stats();
+    Serial.printf("DIAG:CT draws=%lu layouts=%lu hits=%lu uncached=%lu shifted=%lu glyphs=%lu\n",
+                  (unsigned long)ct.draws, (unsigned long)ct.layouts, (unsigned long)ct.cacheHits,
+                  (unsigned long)ct.uncached, (unsigned long)ct.shifted, (unsigned long)ct.measuredGlyphs);
+
+    // old path: 240 * ~47 px band clear + one window per lit font pixel
+    uint32_t upd = tftZoneUpdates ? tftZoneUpdates : 1;
+    Serial.printf("DIAG:ZONE updates=%lu px/upd=%lu win/upd=%lu.%02lu\n",
+                  (unsigned long)tftZoneUpdates, (unsigned long)(tftZonePixels / upd),
+                  (unsigned long)(tftZoneWindows / upd), (unsigned long)(tftZoneWindows * 100 / upd % 100));
+
+    Serial.printf("DIAG:RENDER queued=%lu dropped=%lu overwritten=%lu coalesced=%lu segments=%lu\n",
+                  (unsigned long)renderQueued, (unsigned long)renderDropped,
+                  (unsigned long)(renderStatusBox.overwritten() + renderXYBox.overwritten()),
+                  (unsigned long)renderCoalesced, (unsigned long)renderSegments);
+
+    const auto& tf = tftFrames.stats();
+    const auto& of = oledFrames.stats();
+    Serial.printf("DIAG:FRAME tft frames=%lu skipped=%lu avg=%luus max=%luus\n",
+                  (unsigned long)tf.frames, (unsigned long)tf.skipped,
+                  (unsigned long)tf.avgUs, (unsigned long)tf.maxUs);
+    Serial.printf("DIAG:FRAME oled frames=%lu skipped=%lu avg=%luus max=%luus\n",
+                  (unsigned long)of.frames, (unsigned long)of.skipped,
+                  (unsigned long)of.avgUs, (unsigned long)of.maxUs);
+
+    const auto& op = oledPages.stats();
+    uint32_t fl = op.flushes ? op.flushes : 1;
+    Serial.printf("DIAG:OLED flushes=%lu pages=%lu bytes=%lu bytes/flush=%lu partial=%lu\n",
+                  (unsigned long)op.flushes, (unsigned long)op.pages,
+                  (unsigned long)op.bytes, (unsigned long)(op.bytes / fl), (unsigned long)op.partial);
+
+    const auto& mx = Mux::stats();
+    uint32_t mhz = Mux::cpuMHz();
+    uint32_t sc = mx.scans ? mx.scans : 1;
+    Serial.printf("DIAG:MUX path=%s scans=%lu avg=%luus max=%luus settle_err=%lu/%lu\n",
+                  MuxCfg::FAST_SELECT ? "reg" : "digitalWrite", (unsigned long)mx.scans,
+                  (unsigned long)(mx.sumCycles / sc / mhz), (unsigned long)(mx.maxCycles / mhz),
+                  (unsigned long)mx.settleErrors, (unsigned long)mx.settleChecks);
+
+    const auto& iq = InputQueue::stats();
+    Serial.printf("DIAG:INPUT pushed=%lu overflows=%lu hwm=%lu/%lu lat_max=%luus\n",
+                  (unsigned long)iq.pushed, (unsigned long)iq.overflows,
+                  (unsigned long)iq.highWater, (unsigned long)InputCfg::QUEUE_LEN,
+                  (unsigned long)inputLatencyMaxUs);
+
+    // per-second rates over the report period
+    static uint32_t lastTouchReads = 0, lastTouchIrqs = 0;
+    const auto& ts = CstTouch::stats();
+    uint32_t periodS = DiagCfg::REPORT_MS / 1000;
+    Serial.printf("DIAG:TOUCH mode=%s i2c/s=%lu irq/s=%lu errors=%lu\n",
+                  TouchCfg::USE_INT ? "int" : "poll",
+                  (unsigned long)((ts.reads - lastTouchReads) / periodS),
+                  (unsigned long)((ts.irqs - lastTouchIrqs) / periodS),
+                  (unsigned long)ts.readErrors);
+    lastTouchReads = ts.reads;
+    lastTouchIrqs = ts.irqs;
+
+    const auto& bt = bleTx.stats();
+    uint32_t nf = bt.notifies ? bt.notifies : 1;
+    Serial.printf("DIAG:BLETX mtu=%u notifies=%lu records=%lu per_notify=%lu.%02lu bytes=%lu failed=%lu"
+                  " unframed=%lu truncated=%lu\n",
+                  (unsigned)bleTx.mtu(), (unsigned long)bt.notifies, (unsigned long)bt.records,
+                  (unsigned long)(bt.records / nf), (unsigned long)(bt.records * 100 / nf % 100),
+                  (unsigned long)bt.bytes, (unsigned long)(g_notifyFailed + bt.sendErrors),
+                  (unsigned long)bt.unframed, (unsigned long)bt.truncated);
+
+    // per class: queued/dropped/discarded on disconnect
+    const auto& bq = bleTxQueue.stats();
+    Serial.printf("DIAG:BLEQ ctl=%lu/%lu/%lu tel=%lu/%lu/%lu refused=%lu hwm=%lu,%lu stalls=%lu\n",
+                  (unsigned long)bq.queued[0], (unsigned long)bq.dropped[0], (unsigned long)bq.discarded[0],
+                  (unsigned long)bq.queued[1], (unsigned long)bq.dropped[1], (unsigned long)bq.discarded[1],
+                  (unsigned long)bq.refused, (unsigned long)bq.highWater[0], (unsigned long)bq.highWater[1],
+                  (unsigned long)bleTxStalls);
+
+    Serial.printf("DIAG:RX writes=%lu overflow=%lu too_long=%lu hwm=%lu/%lu deferred=%lu\n",
+                  (unsigned long)g_rxWrites, (unsigned long)g_rxOverflow,
+                  (unsigned long)g_rxTooLong, (unsigned long)g_rxHighWater,
+                  (unsigned long)RxCfg::SLOTS, (unsigned long)g_rxDeferred);
+
+    const auto& ps = g_props.stats();
+    Serial.printf("DIAG:PROPS count=%u/%u sets=%lu changes=%lu full=%lu max_probe=%u\n",
+                  (unsigned)ps.count, (unsigned)PropStore::CAPACITY,
+                  (unsigned long)ps.sets, (unsigned long)ps.changes,
+                  (unsigned long)ps.full, (unsigned)ps.maxProbe);
+
+    const auto& rs = rxDispatch.stats();
+    Serial.printf("DIAG:RXCMD handled=%lu unknown=%lu malformed=%lu rejected=%lu\n",
+                  (unsigned long)rs.handled, (unsigned long)rs.unknown,
+                  (unsigned long)rs.malformed, (unsigned long)rs.rejected);
+
+    const auto& ks = KeySampler::stats();
+    Serial.printf("DIAG:KEYS samples=%lu edges=%lu dropped=%lu rate=%s\n",
+                  (unsigned long)ks.samples, (unsigned long)ks.edges, (unsigned long)ks.dropped,
+                  ks.idle ? "idle" : "fast");
+
+    // idle share over the report period
+    static uint64_t lastBlocked = 0, lastTotal = 0;
+    const auto& wk = Wake::stats();
+    uint64_t blocked = wk.blockedUs - lastBlocked, total = wk.totalUs - lastTotal;
+    lastBlocked = wk.blockedUs;
+    lastTotal = wk.totalUs;
+    Serial.printf("DIAG:LOOP idle=%lu%% wakes=%lu timeouts=%lu lat_avg=%luus lat_max=%luus\n",
+                  (unsigned long)(total ? blocked * 100 / total : 0),
+                  (unsigned long)wk.wakes, (unsigned long)wk.timeouts,
+                  (unsigned long)(wk.wakes ? wk.latSumUs / wk.wakes : 0), (unsigned long)wk.latMaxUs);
 }
 
 // ===================== Setup / Loop =====================
 void setup() {
     delay(150);
     Serial.begin(115200);
+    Wake::begin();
+    oledWatchProps();
 
     // TFT init
     SPI.begin(Pins::TFT_SCL, -1, Pins::TFT_SDA, Pins::TFT_CS);
@@ -475,6 +1251,7 @@ void setup() {
     tft.setRotation(0);
     tft.fillScreen(GC9A01A_BLACK);
     tftText(40, 100, 2, GC9A01A_WHITE, "Init...");
+    tftBand.setTextWrap(false);
 
     // Touch reset
     pinMode(Pins::TP_RST, OUTPUT);
@@ -487,8 +1264,9 @@ void setup() {
     Wire.begin(Pins::I2C_SDA, Pins::I2C_SCL);
     i2cScan();
 
-    // Touch begin
+    // Touch begin; reports are read by CstTouch on INT
     touch.begin();
+    CstTouch::begin(Wire, Pins::TP_INT, !TouchCfg::USE_INT, touchWake);
 
     // OLED init
     oledOk = false;
@@ -498,50 +1276,31 @@ void setup() {
         if (oled.begin(SSD1306_SWITCHCAPVCC, a)) {
             oledOk = true;
             oledAddr = a;
+            oledPages.begin(OledCfg::W, OledCfg::H, a, OledCfg::I2C_HZ, OledCfg::I2C_HZ_AFTER, OLED_DATA_CHUNK);
             break;
         }
     }
 
-    // MUX init
-    pinMode(Pins::MUX_S0, OUTPUT);
-    pinMode(Pins::MUX_S1, OUTPUT);
-    pinMode(Pins::MUX_S2, OUTPUT);
-    pinMode(Pins::MUX_S3, OUTPUT);
-    pinMode(Pins::MUX_EN, OUTPUT);
-    digitalWrite(Pins::MUX_EN, LOW);
-    pinMode(Pins::MUX_SIG, INPUT_PULLUP);
+    // MUX init; settle checks busy-wait, so they run before the sampler starts
+    Mux::begin();
+    for (uint8_t i = 0; i < MuxCfg::BOOT_SETTLE_CHECKS; i++) Mux::checkSettle();
 
-    uint32_t now = millis();
-    for (uint8_t i = 0; i < BtnCfg::BTN_COUNT; i++) {
-        rawState[i] = readButtonPressedByIndex(i);
-        stableState[i] = rawState[i];
-        btnWasDown[i] = stableState[i];
-        btnDownMs[i] = btnWasDown[i] ? now : 0;
-        lastChangeMs[i] = now;
-    }
+    KeySampler::begin([] { Wake::set(Wake::KEYS); });
+    keyMachine.reset(KeySampler::state() >> BtnCfg::BTN_FIRST_CH, (uint32_t)esp_timer_get_time());
 
     // Encoders init
-    pinMode(Pins::ENC1_A, INPUT_PULLUP);
-    pinMode(Pins::ENC1_B, INPUT_PULLUP);
-    pinMode(Pins::ENC2_A, INPUT_PULLUP);
-    pinMode(Pins::ENC2_B, INPUT_PULLUP);
-
-    enc1.begin();
-    enc1.setAcceleration(0);
-
-    enc2.begin();
-    enc2.setAcceleration(0);
-
-    attachInterrupt(digitalPinToInterrupt(Pins::ENC1_A), enc1ISR, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::ENC1_B), enc1ISR, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::ENC2_A), enc2ISR, CHANGE);
-    attachInterrupt(digitalPinToInterrupt(Pins::ENC2_B), enc2ISR, CHANGE);
+    encoders[0] = encoderBegin(enc1Pcnt, enc1Lib);
+    encoders[1] = encoderBegin(enc2Pcnt, enc2Lib);
+    Serial.printf("ENC: %s / %s\n",
+                  (encoders[0] == &enc1Pcnt) ? "pcnt" : "isr",
+                  (encoders[1] == &enc2Pcnt) ? "pcnt" : "isr");
 
     // BLE
     bleInit();
 
-    // Ready
+    // Ready; from here on the TFT belongs to the render task
     tft.fillScreen(GC9A01A_BLACK);
+    renderBegin();
     logPush(Evt::BOOT);
 
     if (oledOk) {
@@ -556,16 +1315,33 @@ void setup() {
 }
 
 void loop() {
-    scanButtons();
-    handleEncoderKeysFromMux();
+    if (g_bleStateChanged) {
+        g_bleStateChanged = false;
+        g_bleLinkChanged = false;
+        bleTxApplyLink();
+        oledFrames.invalidate();
+        renderStatus(g_deviceConnected ? "BLE:ON" : "BLE:OFF");
+    } else if (g_bleLinkChanged) {
+        g_bleLinkChanged = false;
+        bleTxApplyLink();
+    }
+
+    handleKeyEdges();
     handleEncoders();
     handleTouch();
+    dispatchInput();
     oledRender();
 
-    if (g_rxPending) {
-        g_rxPending = false;
-        processRx(g_rxMsg);
+    drainRx();
+
+    bleTxDrain();
+    diagReport();
+
+    uint32_t pushed = InputQueue::stats().pushed;
+    if (pushed != lastInputPushed) {
+        lastInputPushed = pushed;
+        lastActivityMs = millis();
     }
 
-    delay(2);
+    Wake::wait(loopTimeoutMs(millis()));
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+#include <gfxfont.h>
+
+// Adafruit_GFX::charBounds() / getTextBounds() with text wrap off, as in
+// Adafruit GFX 1.11, for host tests that compare against the library.
+// Counts calls and the characters they walk.
+struct GfxReference {
+    const GFXfont* font = nullptr;
+    uint8_t size = 1;
+    uint32_t calls = 0;
+    uint32_t glyphs = 0;
+
+    void charBounds(unsigned char c, int16_t* x, int16_t* y,
+                    int16_t* minx, int16_t* miny, int16_t* maxx, int16_t* maxy) const {
+        if (font) {
+            if (c == '\n') {
+                *x = 0;
+                *y += size * font->yAdvance;
+            } else if (c != '\r' && c >= font->first && c <= font->last) {
+                const GFXglyph& g = font->glyph[c - font->first];
+                int16_t x1 = *x + g.xOffset * size, y1 = *y + g.yOffset * size;
+                int16_t x2 = x1 + g.width * size - 1, y2 = y1 + g.height * size - 1;
+                if (x1 < *minx) *minx = x1;
+                if (y1 < *miny) *miny = y1;
+                if (x2 > *maxx) *maxx = x2;
+                if (y2 > *maxy) *maxy = y2;
+                *x += g.xAdvance * size;
+            }
+            return;
+        }
+
+        if (c == '\n') {
+            *x = 0;
+            *y += size * 8;
+        } else if (c != '\r') {
+            int16_t x2 = *x + size * 6 - 1, y2 = *y + size * 8 - 1;
+            if (x2 > *maxx) *maxx = x2;
+            if (y2 > *maxy) *maxy = y2;
+            if (*x < *minx) *minx = *x;
+            if (*y < *miny) *miny = *y;
+            *x += size * 6;
+        }
+    }
+
+    void getTextBounds(const char* s, int16_t x, int16_t y,
+                       int16_t* x1, int16_t* y1, uint16_t* w, uint16_t* h) {
+        calls++;
+        int16_t minx = 0x7FFF, miny = 0x7FFF, maxx = -1, maxy = -1;
+        *x1 = x;
+        *y1 = y;
+        *w = *h = 0;
+        for (uint8_t c; (c = (uint8_t)*s++) != 0; glyphs++) charBounds(c, &x, &y, &minx, &miny, &maxx, &maxy);
+        if (maxx >= minx) { *x1 = minx; *w = maxx - minx + 1; }
+        if (maxy >= miny) { *y1 = miny; *h = maxy - miny + 1; }
+    }
+
+    uint16_t width(const char* s) {
+        int16_t x1, y1;
+        uint16_t w, h;
+        getTextBounds(s, 0, 0, &x1, &y1, &w, &h);
+        return w;
+    }
+};
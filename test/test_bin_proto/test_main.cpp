@@ -0,0 +1,146 @@
+#include <limits.h>
+#include <string.h>
+#include <unity.h>
+
+#include "BinProto.h"
+
+using namespace BinProto;
+
+// BtnCfg::BTN_COUNT; AppConfig.h pulls in Arduino.h
+static constexpr uint8_t BTN_COUNT = 16;
+
+void setUp() {}
+void tearDown() {}
+
+// encode -> decode, checks every field comes back
+static void roundTrip(uint8_t op, uint8_t seq, const int32_t* args, uint8_t argc) {
+    uint8_t buf[MAX_FRAME];
+    size_t n = encode(buf, sizeof(buf), op, seq, args, argc);
+    TEST_ASSERT_GREATER_THAN_MESSAGE(0, n, "encode");
+    TEST_ASSERT_TRUE(n <= MAX_FRAME);
+
+    Frame f;
+    TEST_ASSERT_TRUE(decode(buf, n, f));
+    TEST_ASSERT_EQUAL_UINT8(op, f.op);
+    TEST_ASSERT_EQUAL_UINT8(seq, f.seq);
+    TEST_ASSERT_EQUAL_UINT8(argc, f.argc);
+    if (argc) TEST_ASSERT_EQUAL_INT32_ARRAY(args, f.args, argc);
+    TEST_ASSERT_NULL(f.text);
+}
+
+static void test_button_events_round_trip() {
+    static const uint8_t ops[] = {OP_BTN_CLICK, OP_BTN_LONG, OP_BTN_DOUBLE};
+    uint8_t seq = 0;
+    for (uint8_t op : ops) {
+        for (int32_t idx = 0; idx < BTN_COUNT; idx++) {
+            roundTrip(op, seq++, &idx, 1);
+
+            // an index fits one byte: op, seq, idx
+            uint8_t buf[MAX_FRAME];
+            TEST_ASSERT_EQUAL(3, encode(buf, sizeof(buf), op, 0, &idx, 1));
+        }
+    }
+}
+
+static void test_every_op_round_trips() {
+    const int32_t enc[] = {2, -7};
+    const int32_t xy[] = {239, 0};
+    const int32_t gesture[] = {3, -180, 179};
+    roundTrip(OP_ENC_KEY, 1, enc, 2);
+    roundTrip(OP_ENC_DELTA, 2, enc, 2);
+    roundTrip(OP_TOUCH_DOWN, 3, xy, 2);
+    roundTrip(OP_TOUCH_UP, 4, nullptr, 0);
+    roundTrip(OP_TOUCH_XY, 5, xy, 2);
+    roundTrip(OP_GESTURE, 6, gesture, 3);
+}
+
+static void test_extreme_args_round_trip() {
+    const int32_t args[MAX_ARGS] = {INT32_MIN, INT32_MAX, -1, 0, 1, -64};
+    roundTrip(OP_GESTURE, 255, args, MAX_ARGS);
+
+    // MAX_FRAME holds the widest frame
+    const int32_t widest[MAX_ARGS] = {INT32_MIN, INT32_MIN, INT32_MIN, INT32_MIN, INT32_MIN, INT32_MIN};
+    uint8_t buf[MAX_FRAME];
+    TEST_ASSERT_EQUAL(MAX_FRAME, encode(buf, sizeof(buf), OP_GESTURE, 0, widest, MAX_ARGS));
+}
+
+static void test_zigzag_and_varint() {
+    const int32_t vals[] = {0, -1, 1, -64, 63, 64, -65, INT32_MIN, INT32_MAX};
+    for (int32_t v : vals) TEST_ASSERT_EQUAL_INT32(v, unzigzag(zigzag(v)));
+    TEST_ASSERT_EQUAL_UINT32(1, zigzag(-1));
+    TEST_ASSERT_EQUAL_UINT32(2, zigzag(1));
+
+    // 1 byte up to 127, VARINT_MAX for the full range
+    uint8_t b[VARINT_MAX];
+    TEST_ASSERT_EQUAL(1, putVarint(b, sizeof(b), 127));
+    TEST_ASSERT_EQUAL(2, putVarint(b, sizeof(b), 128));
+    TEST_ASSERT_EQUAL(VARINT_MAX, putVarint(b, sizeof(b), UINT32_MAX));
+    uint32_t v = 0;
+    TEST_ASSERT_EQUAL(VARINT_MAX, getVarint(b, sizeof(b), &v));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, v);
+
+    // no room
+    TEST_ASSERT_EQUAL(0, putVarint(b, 1, 128));
+}
+
+static void test_text_round_trips() {
+    const char* msg = "EVT:DRIVER_HEAT_OFF";
+    uint8_t buf[32];
+    size_t n = encodeText(buf, sizeof(buf), 9, msg, strlen(msg));
+    TEST_ASSERT_EQUAL(strlen(msg) + 2, n);
+
+    Frame f;
+    TEST_ASSERT_TRUE(decode(buf, n, f));
+    TEST_ASSERT_EQUAL_UINT8(OP_TEXT, f.op);
+    TEST_ASSERT_EQUAL_UINT8(9, f.seq);
+    TEST_ASSERT_EQUAL_UINT8(0, f.argc);
+    TEST_ASSERT_EQUAL(strlen(msg), f.textLen);
+    TEST_ASSERT_EQUAL_MEMORY(msg, f.text, f.textLen);
+
+    // truncated to fit, never overrun
+    n = encodeText(buf, 8, 0, msg, strlen(msg));
+    TEST_ASSERT_EQUAL(8, n);
+    TEST_ASSERT_TRUE(decode(buf, n, f));
+    TEST_ASSERT_EQUAL(6, f.textLen);
+    TEST_ASSERT_EQUAL_MEMORY(msg, f.text, 6);
+}
+
+static void test_encode_refuses_what_does_not_fit() {
+    const int32_t args[MAX_ARGS + 1] = {};
+    uint8_t buf[MAX_FRAME];
+    TEST_ASSERT_EQUAL(0, encode(buf, sizeof(buf), OP_GESTURE, 0, args, MAX_ARGS + 1));
+    TEST_ASSERT_EQUAL(0, encode(buf, 1, OP_TOUCH_UP, 0, nullptr, 0));
+
+    const int32_t big = INT32_MIN;
+    TEST_ASSERT_EQUAL(0, encode(buf, 4, OP_BTN_CLICK, 0, &big, 1));
+    TEST_ASSERT_EQUAL(0, encodeText(buf, 1, 0, "x", 1));
+}
+
+static void test_decode_rejects_malformed() {
+    Frame f;
+    const uint8_t shortFrame[] = {OP_BTN_CLICK};
+    TEST_ASSERT_FALSE(decode(shortFrame, sizeof(shortFrame), f));
+
+    // varint cut off by the end of the frame
+    const uint8_t cut[] = {OP_ENC_DELTA, 0, 0x02, 0x80};
+    TEST_ASSERT_FALSE(decode(cut, sizeof(cut), f));
+
+    // continuation bit on every byte
+    const uint8_t endless[] = {OP_BTN_CLICK, 0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+    TEST_ASSERT_FALSE(decode(endless, sizeof(endless), f));
+
+    uint8_t tooMany[2 + MAX_ARGS + 1] = {OP_GESTURE, 0};
+    TEST_ASSERT_FALSE(decode(tooMany, sizeof(tooMany), f));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_button_events_round_trip);
+    RUN_TEST(test_every_op_round_trips);
+    RUN_TEST(test_extreme_args_round_trip);
+    RUN_TEST(test_zigzag_and_varint);
+    RUN_TEST(test_text_round_trips);
+    RUN_TEST(test_encode_refuses_what_does_not_fit);
+    RUN_TEST(test_decode_rejects_malformed);
+    return UNITY_END();
+}
@@ -0,0 +1,237 @@
+#pragma once
+// The String/getTextBounds() CircleText this module replaced, kept as the
+// reference for host tests. Lines are recorded instead of printed.
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "CircleText.h"
+#include "GfxReference.h"
+
+struct OldLine {
+    std::string text;
+    int16_t x;
+    int16_t y;
+};
+
+class OldCircleText {
+public:
+    explicit OldCircleText(GfxReference& gfx) : gfx_(gfx) {}
+
+    std::vector<OldLine> draw(const CircleTextConfig& cfg, const char* text, CircleTextPos pos) {
+        gfx_.font = cfg.font;
+        gfx_.size = cfg.textSize;
+        lines_.clear();
+        drawWrapped(cfg, text, pos);
+        return lines_;
+    }
+
+private:
+    void measureText(const char* s, int16_t* w, int16_t* h) {
+        int16_t x1, y1;
+        uint16_t ww, hh;
+        gfx_.getTextBounds(s, 0, 0, &x1, &y1, &ww, &hh);
+        *w = (int16_t)ww;
+        *h = (int16_t)hh;
+    }
+
+    int16_t textLineHeight() {
+        int16_t w, h;
+        measureText("Ay", &w, &h);
+        return (h > 0) ? h : 8;
+    }
+
+    size_t fitCharsIntoWidth(const char* s, int16_t maxW) {
+        char tmp[96];
+        size_t n = 0;
+        tmp[0] = '\0';
+        while (s[n] && n < sizeof(tmp) - 1) {
+            tmp[n] = s[n];
+            tmp[n + 1] = '\0';
+            int16_t w, h;
+            measureText(tmp, &w, &h);
+            if (w > maxW) return (n == 0) ? 1 : n;
+            n++;
+        }
+        return n;
+    }
+
+    static bool circleLineBounds(int16_t cx, int16_t cy, int16_t R, int16_t y, int16_t margin,
+                                 int16_t* xLeft, int16_t* xRight) {
+        int32_t dy = (int32_t)y - (int32_t)cy;
+        int32_t rr = (int32_t)R * (int32_t)R;
+        int32_t ddy = dy * dy;
+        if (ddy >= rr) return false;
+
+        float dx = sqrtf((float)(rr - ddy));
+        int16_t xl = (int16_t)roundf((float)cx - dx) + margin;
+        int16_t xr = (int16_t)roundf((float)cx + dx) - margin;
+        if (xr <= xl) return false;
+        *xLeft = xl;
+        *xRight = xr;
+        return true;
+    }
+
+    int16_t layoutHeight(const CircleTextConfig& cfg, const char* text) {
+        int16_t lineH = textLineHeight();
+        (void)lineH;
+        int16_t cursorY = cfg.topY;
+        std::string line;
+
+        auto flushLine = [&]() -> bool {
+            if (line.empty()) return true;
+            int16_t lw, lh;
+            measureText(line.c_str(), &lw, &lh);
+            cursorY += lh + cfg.lineGap;
+            line.clear();
+            return cursorY <= cfg.bottomY;
+        };
+
+        const char* p = text;
+        while (*p) {
+            while (*p == ' ') p++;
+            int16_t xL, xR;
+            if (*p == '\n') {
+                if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) break;
+                flushLine();
+                cursorY += cfg.lineGap;
+                p++;
+                continue;
+            }
+            if (!*p) break;
+            if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) break;
+            int16_t maxW = xR - xL;
+
+            const char* start = p;
+            while (*p && *p != ' ' && *p != '\n') p++;
+            std::string word(start, p);
+            if (word.empty()) continue;
+
+            std::string candidate = line;
+            if (!candidate.empty()) candidate += " ";
+            candidate += word;
+
+            int16_t candW, candH;
+            measureText(candidate.c_str(), &candW, &candH);
+            if (candW <= maxW) {
+                line = candidate;
+                continue;
+            }
+            if (!line.empty()) {
+                if (!flushLine()) break;
+                if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) break;
+                maxW = xR - xL;
+            }
+            int16_t wordW, wordH;
+            measureText(word.c_str(), &wordW, &wordH);
+            if (wordW <= maxW) {
+                line = word;
+                continue;
+            }
+            const char* ws = word.c_str();
+            while (*ws) {
+                if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) break;
+                maxW = xR - xL;
+                size_t chunkLen = fitCharsIntoWidth(ws, maxW);
+                line.assign(ws, chunkLen);
+                if (!flushLine()) break;
+                ws += chunkLen;
+            }
+        }
+        if (!line.empty()) {
+            int16_t xL, xR;
+            if (circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) {
+                int16_t lw, lh;
+                measureText(line.c_str(), &lw, &lh);
+                cursorY += lh;
+            }
+        }
+        int16_t used = cursorY - cfg.topY;
+        return used < 0 ? 0 : used;
+    }
+
+    void drawWrapped(const CircleTextConfig& cfg, const char* text, CircleTextPos pos) {
+        int16_t h = layoutHeight(cfg, text);
+        int16_t available = cfg.bottomY - cfg.topY;
+        if (available < 0) available = 0;
+
+        int16_t startY = cfg.topY;
+        if (pos == CircleTextPos::Center) startY = cfg.topY + (available - h) / 2;
+        else if (pos == CircleTextPos::Bottom) startY = cfg.bottomY - h;
+        if (startY < cfg.topY) startY = cfg.topY;
+
+        int16_t cursorY = startY;
+        std::string line;
+
+        auto flushLine = [&](int16_t xLeft) -> bool {
+            if (line.empty()) return true;
+            int16_t lw, lh;
+            measureText(line.c_str(), &lw, &lh);
+            if (cursorY + lh > cfg.bottomY) return false;
+            lines_.push_back({line, xLeft, cursorY});
+            cursorY += lh + cfg.lineGap;
+            line.clear();
+            return true;
+        };
+
+        const char* p = text;
+        while (*p) {
+            while (*p == ' ') p++;
+            int16_t xL, xR;
+            if (*p == '\n') {
+                if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
+                if (!flushLine(xL)) return;
+                cursorY += cfg.lineGap;
+                p++;
+                continue;
+            }
+            if (!*p) break;
+            if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
+            int16_t maxW = xR - xL;
+
+            const char* start = p;
+            while (*p && *p != ' ' && *p != '\n') p++;
+            std::string word(start, p);
+            if (word.empty()) continue;
+
+            std::string candidate = line;
+            if (!candidate.empty()) candidate += " ";
+            candidate += word;
+
+            int16_t candW, candH;
+            measureText(candidate.c_str(), &candW, &candH);
+            if (candW <= maxW) {
+                line = candidate;
+                continue;
+            }
+            if (!line.empty()) {
+                if (!flushLine(xL)) return;
+                if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
+                maxW = xR - xL;
+            }
+            int16_t wordW, wordH;
+            measureText(word.c_str(), &wordW, &wordH);
+            if (wordW <= maxW) {
+                line = word;
+                continue;
+            }
+            const char* ws = word.c_str();
+            while (*ws) {
+                if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
+                maxW = xR - xL;
+                size_t chunkLen = fitCharsIntoWidth(ws, maxW);
+                line.assign(ws, chunkLen);
+                if (!flushLine(xL)) return;
+                ws += chunkLen;
+            }
+        }
+        if (!line.empty()) {
+            int16_t xL, xR;
+            if (!circleLineBounds(cfg.cx, cfg.cy, cfg.r, cursorY, cfg.margin, &xL, &xR)) return;
+            flushLine(xL);
+        }
+    }
+
+    GfxReference& gfx_;
+    std::vector<OldLine> lines_;
+};
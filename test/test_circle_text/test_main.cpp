@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <new>
+#include <unity.h>
+
+#include "CircleText.h"
+#include "TextMetrics.h"
+#include "OldCircleText.h"
+
+static constexpr CircleGeometry kRound{120, 120, 118};
+
+// TftTextCfg::Status()
+static CircleTextConfig statusCfg() {
+    CircleTextConfig c;
+    c.cx = 120; c.cy = 120; c.r = 118;
+    c.geometry = &kRound;
+    c.topY = 6;
+    c.bottomY = 52;
+    c.margin = 8;
+    c.lineGap = 2;
+    c.textSize = 2;
+    return c;
+}
+
+// status lines as logPush() produces them during an encoder spin and a drag
+static const char* const kMix[] = {
+    "EVT:TEMP_MAIN:+1", "EVT:TEMP_MAIN:+1", "EVT:TEMP_MAIN:+2", "EVT:TEMP_MAIN:+1",
+    "EVT:TEMP_PASS:-1", "EVT:BTN:C3:CLICK", "EVT:CLIMATE_WINDOWS", "EVT:TOUCH:X=123,Y=45",
+    "EVT:TOUCH:X=130,Y=52", "REAR_DEF:ON", "TEMP:1:22.5", "FAN:8:L3",
+    "EVT:GEST:ROT:+90", "RX:GIB:FLOAT:268828928:1:22.5", "EVT:TEMP_MAIN:+1", "EVT:TEMP_MAIN:+1",
+};
+static constexpr size_t kMixLen = sizeof(kMix) / sizeof(kMix[0]);
+
+// Allocation hook: counts operator new and, on glibc without ASan, malloc
+static bool gCountAllocs = false;
+static uint32_t gAllocs = 0;
+
+void* operator new(size_t n) {
+    if (gCountAllocs) gAllocs++;
+    void* p = malloc(n ? n : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+
+extern "C" void* malloc(size_t n) {
+    if (gCountAllocs) gAllocs++;
+    return __libc_malloc(n);
+}
+extern "C" void* calloc(size_t n, size_t m) {
+    if (gCountAllocs) gAllocs++;
+    return __libc_calloc(n, m);
+}
+extern "C" void* realloc(void* p, size_t n) {
+    if (gCountAllocs) gAllocs++;
+    return __libc_realloc(p, n);
+}
+#endif
+
+// wrapping edge cases on top of kMix
+static const char* const kEdge[] = {
+    "",
+    "   ",
+    "A",
+    "two words",
+    "  leading and trailing  ",
+    "line one\nline two",
+    "\nstarts with a newline",
+    "EVT:AVERYLONGTOKENWITHOUTANYSPACESTHATHASTOBESPLIT",
+    "one two three four five six seven eight nine ten eleven twelve thirteen",
+    "short then AVERYLONGTOKENWITHOUTANYSPACESTHATHASTOBESPLIT tail",
+};
+static constexpr size_t kEdgeLen = sizeof(kEdge) / sizeof(kEdge[0]);
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_single_pass_measures_fewer_glyphs(void) {
+    CircleTextConfig cfg = statusCfg();
+    GfxReference ref;
+    OldCircleText old(ref);
+    CircleTextLayout out;
+
+    uint32_t before = CircleText::stats().measuredGlyphs;
+    for (size_t i = 0; i < kMixLen; i++) {
+        old.draw(cfg, kMix[i], CircleTextPos::Top);
+        CircleText::layout(cfg, kMix[i], CircleTextPos::Top, out);
+    }
+    uint32_t glyphs = CircleText::stats().measuredGlyphs - before;
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "getTextBounds: %lu calls, %lu glyphs; single pass: %lu glyphs",
+             (unsigned long)ref.calls, (unsigned long)ref.glyphs, (unsigned long)glyphs);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_THAN(ref.glyphs / 4, glyphs);
+}
+
+static void test_cache_skips_repeated_layouts(void) {
+    CircleTextConfig cfg = statusCfg();
+    CircleText::Stats s0 = CircleText::stats();
+
+    // encoder spin: the same two messages over and over
+    for (int i = 0; i < 40; i++) {
+        CircleText::layoutCached(cfg, (i & 1) ? "EVT:TEMP_PASS:+1" : "EVT:TEMP_PASS:-1", CircleTextPos::Top);
+    }
+
+    CircleText::Stats s1 = CircleText::stats();
+    TEST_ASSERT_EQUAL_UINT32(40, s1.draws - s0.draws);
+    TEST_ASSERT_EQUAL_UINT32(2, s1.layouts - s0.layouts);
+    TEST_ASSERT_EQUAL_UINT32(38, s1.cacheHits - s0.cacheHits);
+
+    // same text, different position or config: separate entries
+    // (Center takes two passes this close to the top of the circle)
+    CircleText::layoutCached(cfg, "EVT:TEMP_PASS:+1", CircleTextPos::Center);
+    cfg.margin = 10;
+    CircleText::layoutCached(cfg, "EVT:TEMP_PASS:+1", CircleTextPos::Top);
+    TEST_ASSERT_EQUAL_UINT32(2 + 2 + 1, CircleText::stats().layouts - s0.layouts);
+}
+
+// FNV-1a collides on these two; only the stored text tells them apart
+static void test_cache_hit_needs_the_same_text(void) {
+    CircleTextConfig cfg = statusCfg();
+    CircleText::layoutCached(cfg, "EVT:0390EA", CircleTextPos::Top);
+
+    CircleText::Stats s0 = CircleText::stats();
+    CircleText::layoutCached(cfg, "EVT:07B050", CircleTextPos::Top);
+    CircleText::Stats s1 = CircleText::stats();
+    TEST_ASSERT_EQUAL_UINT32(0, s1.cacheHits - s0.cacheHits);
+    TEST_ASSERT_EQUAL_UINT32(1, s1.layouts - s0.layouts);
+
+    // too long to keep a copy: laid out every time, never cached
+    char longText[CircleText::CACHE_TEXT + 8];
+    memset(longText, 'W', sizeof(longText) - 1);
+    longText[sizeof(longText) - 1] = '\0';
+    CircleText::layoutCached(cfg, longText, CircleTextPos::Top);
+    CircleText::layoutCached(cfg, longText, CircleTextPos::Top);
+    CircleText::Stats s2 = CircleText::stats();
+    TEST_ASSERT_EQUAL_UINT32(2, s2.uncached - s1.uncached);
+    TEST_ASSERT_EQUAL_UINT32(0, s2.cacheHits - s1.cacheHits);
+}
+
+static void assertSameLines(const CircleTextLayout& a, const CircleTextLayout& b) {
+    TEST_ASSERT_EQUAL_UINT8(a.count, b.count);
+    for (uint8_t i = 0; i < a.count; i++) {
+        TEST_ASSERT_EQUAL_UINT16(a.lines[i].start, b.lines[i].start);
+        TEST_ASSERT_EQUAL_UINT8(a.lines[i].len, b.lines[i].len);
+        TEST_ASSERT_EQUAL_INT16(a.lines[i].xLeft, b.lines[i].xLeft);
+        TEST_ASSERT_EQUAL_INT16(a.lines[i].y, b.lines[i].y);
+    }
+}
+
+// Rows 110..131 are all 118 px half-chords, so centering only moves the text
+static void test_center_moves_without_rewrap_on_equal_rows(void) {
+    CircleTextConfig cfg = statusCfg();
+    cfg.topY = 110;
+    cfg.bottomY = 131;
+    const char* text = "EVT:TEMP:+1";
+
+    CircleText::Stats s0 = CircleText::stats();
+    CircleTextLayout centered;
+    CircleText::layout(cfg, text, CircleTextPos::Center, centered);
+    CircleText::Stats s1 = CircleText::stats();
+    TEST_ASSERT_EQUAL_UINT32(1, s1.layouts - s0.layouts);
+    TEST_ASSERT_EQUAL_UINT32(1, s1.shifted - s0.shifted);
+
+    CircleTextConfig at = cfg;
+    at.topY = centered.lines[0].y;
+    CircleTextLayout top;
+    CircleText::layout(at, text, CircleTextPos::Top, top);
+    assertSameLines(top, centered);
+    TEST_ASSERT_EQUAL_INT16(top.box.y0, centered.box.y0);
+    TEST_ASSERT_EQUAL_INT16(top.box.y1, centered.box.y1);
+}
+
+// Near the top every row has its own chord, so the text is wrapped again
+static void test_center_rewraps_when_rows_change(void) {
+    CircleTextConfig cfg = statusCfg();
+    cfg.bottomY = 80;
+    const char* text = "EVT:CLIMATE_WINDOWS ON";
+
+    CircleText::Stats s0 = CircleText::stats();
+    CircleTextLayout centered;
+    CircleText::layout(cfg, text, CircleTextPos::Center, centered);
+    CircleText::Stats s1 = CircleText::stats();
+    TEST_ASSERT_EQUAL_UINT32(2, s1.layouts - s0.layouts);
+    TEST_ASSERT_EQUAL_UINT32(0, s1.shifted - s0.shifted);
+
+    GfxReference ref;
+    OldCircleText old(ref);
+    std::vector<OldLine> want = old.draw(cfg, text, CircleTextPos::Center);
+    TEST_ASSERT_EQUAL_UINT8(want.size(), centered.count);
+    for (uint8_t i = 0; i < centered.count; i++) {
+        TEST_ASSERT_EQUAL_INT16(want[i].y, centered.lines[i].y);
+        TEST_ASSERT_EQUAL_INT16(want[i].x, centered.lines[i].xLeft);
+    }
+}
+
+static void test_layout_makes_no_heap_allocations(void) {
+    CircleTextConfig cfg = statusCfg();
+    CircleTextLayout out;
+    const CircleTextPos positions[] = {CircleTextPos::Top, CircleTextPos::Center, CircleTextPos::Bottom};
+
+    gAllocs = 0;
+    gCountAllocs = true;
+    for (CircleTextPos pos : positions) {
+        for (size_t i = 0; i < kMixLen; i++) {
+            CircleText::layout(cfg, kMix[i], pos, out);
+            CircleText::layoutCached(cfg, kMix[i], pos);
+        }
+        for (size_t i = 0; i < kEdgeLen; i++) {
+            CircleText::layout(cfg, kEdge[i], pos, out);
+            CircleText::layoutCached(cfg, kEdge[i], pos);
+        }
+    }
+    gCountAllocs = false;
+    TEST_ASSERT_EQUAL_UINT32(0, gAllocs);
+
+    // the hook itself works
+    gCountAllocs = true;
+    std::string probe(64, 'x');
+    gCountAllocs = false;
+    TEST_ASSERT_GREATER_THAN(0, gAllocs);
+}
+
+static void assertSameAsOld(const CircleTextConfig& cfg, const char* text, const CircleTextLayout& got, const char* msg) {
+    GfxReference ref;
+    OldCircleText old(ref);
+    std::vector<OldLine> want = old.draw(cfg, text, CircleTextPos::Top);
+
+    TEST_ASSERT_EQUAL_INT_MESSAGE(want.size(), got.count, msg);
+    for (uint8_t i = 0; i < got.count; i++) {
+        const CircleTextLine& l = got.lines[i];
+        std::string slice(text + l.start, l.len);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(want[i].text.c_str(), slice.c_str(), msg);
+        TEST_ASSERT_EQUAL_INT16_MESSAGE(want[i].x, l.xLeft, msg);
+        TEST_ASSERT_EQUAL_INT16_MESSAGE(want[i].y, l.y, msg);
+    }
+}
+
+// Same lines at the same places as the String implementation. Center and
+// Bottom pick their start row from the lines actually placed; the old
+// pre-pass also counted lines past bottomY and the gap after a split
+// chunk, so those are checked by wrapping from the start row chosen here.
+static void test_lines_match_old_implementation(void) {
+    CircleTextConfig zones[3] = {statusCfg(), statusCfg(), statusCfg()};
+    zones[1].topY = 188;     // TftTextCfg bottom zone
+    zones[1].bottomY = 236;
+    zones[2].topY = 60;      // roomy middle zone, size 1
+    zones[2].bottomY = 180;
+    zones[2].textSize = 1;
+
+    const char* const* sets[] = {kMix, kEdge};
+    const size_t lens[] = {kMixLen, kEdgeLen};
+    const CircleTextPos positions[] = {CircleTextPos::Top, CircleTextPos::Center, CircleTextPos::Bottom};
+
+    for (const CircleTextConfig& cfg : zones) {
+        for (CircleTextPos pos : positions) {
+            for (size_t s = 0; s < 2; s++) {
+                for (size_t i = 0; i < lens[s]; i++) {
+                    const char* text = sets[s][i];
+                    CircleTextLayout got;
+                    CircleText::layout(cfg, text, pos, got);
+
+                    // height runs from the start row to the bottom of the last line
+                    CircleTextConfig from = cfg;
+                    if (got.count) {
+                        int16_t lineH = TextMetrics(cfg.font, cfg.textSize).lineHeight();
+                        from.topY = got.lines[got.count - 1].y + lineH - got.height;
+                    }
+                    TEST_ASSERT_TRUE(from.topY >= cfg.topY);
+
+                    char msg[128];
+                    snprintf(msg, sizeof(msg), "\"%s\" pos %d top %d", text, (int)pos, cfg.topY);
+                    assertSameAsOld(from, text, got, msg);
+                }
+            }
+        }
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_single_pass_measures_fewer_glyphs);
+    RUN_TEST(test_cache_skips_repeated_layouts);
+    RUN_TEST(test_cache_hit_needs_the_same_text);
+    RUN_TEST(test_center_moves_without_rewrap_on_equal_rows);
+    RUN_TEST(test_center_rewraps_when_rows_change);
+    RUN_TEST(test_layout_makes_no_heap_allocations);
+    RUN_TEST(test_lines_match_old_implementation);
+    return UNITY_END();
+}
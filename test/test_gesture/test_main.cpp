@@ -0,0 +1,189 @@
+#include <math.h>
+#include <stdio.h>
+#include <unity.h>
+
+#include "Gesture.h"
+
+// TouchCfg::GESTURE
+static constexpr GestureCfg CFG = {120, 120, 10, 600, 40, 40, 45, 80};
+
+struct Pt {
+    uint16_t t;     // ms since the finger went down
+    int16_t x, y;
+};
+
+// Touch traces as the CST816S path delivers them: a report about every
+// 10 ms with a couple of px of jitter
+static const Pt kTap[] = {
+    {0, 60, 150}, {10, 61, 150}, {20, 61, 151}, {30, 60, 152}, {40, 62, 151}, {50, 61, 150},
+};
+static const Pt kHold[] = {
+    {0, 180, 90}, {100, 181, 91}, {200, 180, 92}, {300, 182, 90}, {400, 181, 89},
+    {500, 180, 90}, {600, 181, 91}, {700, 180, 90}, {800, 181, 90},
+};
+static const Pt kSwipeLeft[] = {
+    {0, 200, 118}, {10, 190, 119}, {20, 172, 121}, {30, 150, 122}, {40, 126, 121},
+    {50, 104, 120}, {60, 88, 122}, {70, 80, 123},
+};
+static const Pt kSwipeUp[] = {
+    {0, 118, 190}, {10, 119, 178}, {20, 121, 160}, {30, 122, 138}, {40, 121, 117}, {50, 123, 101},
+};
+// drag that wobbles but stays inside the tap slop, then lifts slowly
+static const Pt kSlowTap[] = {
+    {0, 120, 40}, {50, 124, 43}, {100, 127, 44}, {200, 126, 46}, {300, 123, 44},
+};
+
+static GestureRecognizer rec(CFG);
+
+// Replays a trace with a tick() per report; returns what up() says, or the
+// tick() gesture if one fired
+static Gesture replay(const Pt* p, size_t n, uint16_t upAt, Gesture* fromTick = nullptr) {
+    Gesture ticked;
+    rec.down(p[0].x, p[0].y, 1000 + p[0].t);
+    for (size_t i = 1; i < n; i++) {
+        rec.move(p[i].x, p[i].y);
+        Gesture g = rec.tick(1000 + p[i].t);
+        if (g.kind != Gesture::None) ticked = g;
+    }
+    if (fromTick) *fromTick = ticked;
+    return rec.up(1000 + upAt);
+}
+
+// arc around the centre: r px, from deg0 to deg1 (clockwise on screen), one
+// report per 10 ms and `step` degrees
+static size_t arc(Pt* out, size_t cap, float r, float deg0, float deg1, float step, float rEnd = -1) {
+    if (rEnd < 0) rEnd = r;
+    size_t n = 0;
+    int steps = (int)(fabsf(deg1 - deg0) / step);
+    for (int i = 0; i <= steps && n < cap; i++) {
+        float f = steps ? (float)i / steps : 0;
+        float a = (deg0 + (deg1 - deg0) * f) * (float)M_PI / 180.0f;
+        float rr = r + (rEnd - r) * f;
+        // small deterministic jitter
+        int16_t jx = (int16_t)((i * 7) % 3 - 1), jy = (int16_t)((i * 5) % 3 - 1);
+        out[n++] = {(uint16_t)(i * 10), (int16_t)(lroundf(120 + rr * cosf(a)) + jx),
+                    (int16_t)(lroundf(120 + rr * sinf(a)) + jy)};
+    }
+    return n;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_tap(void) {
+    Gesture g = replay(kTap, sizeof(kTap) / sizeof(kTap[0]), 60);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::Tap, g.kind);
+    TEST_ASSERT_EQUAL_INT16(60, g.a);
+    TEST_ASSERT_EQUAL_INT16(150, g.b);
+
+    g = replay(kSlowTap, sizeof(kSlowTap) / sizeof(kSlowTap[0]), 310);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::Tap, g.kind);
+}
+
+static void test_long_press_fires_once_from_tick(void) {
+    Gesture ticked;
+    Gesture g = replay(kHold, sizeof(kHold) / sizeof(kHold[0]), 850, &ticked);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::LongPress, ticked.kind);
+    TEST_ASSERT_EQUAL_INT16(180, ticked.a);
+    TEST_ASSERT_EQUAL_INT16(90, ticked.b);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::None, g.kind);     // nothing more on lift
+}
+
+static void test_swipes(void) {
+    Gesture g = replay(kSwipeLeft, sizeof(kSwipeLeft) / sizeof(kSwipeLeft[0]), 75);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::SwipeLeft, g.kind);
+    TEST_ASSERT_EQUAL_INT16(120, g.a);
+
+    g = replay(kSwipeUp, sizeof(kSwipeUp) / sizeof(kSwipeUp[0]), 55);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::SwipeUp, g.kind);
+    TEST_ASSERT_EQUAL_INT16(89, g.a);
+
+    // mirrored traces
+    Pt m[16];
+    size_t n = sizeof(kSwipeLeft) / sizeof(kSwipeLeft[0]);
+    for (size_t i = 0; i < n; i++) m[i] = {kSwipeLeft[i].t, (int16_t)(240 - kSwipeLeft[i].x), kSwipeLeft[i].y};
+    TEST_ASSERT_EQUAL_UINT8(Gesture::SwipeRight, replay(m, n, 75).kind);
+
+    n = sizeof(kSwipeUp) / sizeof(kSwipeUp[0]);
+    for (size_t i = 0; i < n; i++) m[i] = {kSwipeUp[i].t, kSwipeUp[i].x, (int16_t)(240 - kSwipeUp[i].y)};
+    TEST_ASSERT_EQUAL_UINT8(Gesture::SwipeDown, replay(m, n, 55).kind);
+}
+
+static void test_rotate_both_ways(void) {
+    Pt p[128];
+    size_t n = arc(p, 128, 90, -90, 0, 4);          // 12 o'clock to 3 o'clock
+    Gesture g = replay(p, n, p[n - 1].t + 5);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::Rotate, g.kind);
+    TEST_ASSERT_INT_WITHIN(2, 90, g.a);
+
+    n = arc(p, 128, 100, 90, -135, 5);              // 6 o'clock back past 12
+    g = replay(p, n, p[n - 1].t + 5);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::Rotate, g.kind);
+    TEST_ASSERT_INT_WITHIN(2, -225, g.a);
+
+    // more than a full turn accumulates
+    n = arc(p, 128, 80, 0, 400, 6);
+    g = replay(p, n, p[n - 1].t + 5);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::Rotate, g.kind);
+    TEST_ASSERT_INT_WITHIN(2, 400, g.a);
+}
+
+static void test_short_arc_is_a_swipe(void) {
+    Pt p[64];
+    size_t n = arc(p, 64, 110, -110, -75, 3);       // 35 deg across the top, chord ~66 px
+    Gesture g = replay(p, n, p[n - 1].t + 5);
+    TEST_ASSERT_NOT_EQUAL(Gesture::Rotate, g.kind);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::SwipeRight, g.kind);
+}
+
+// radius shrinking from 100 to 50 px: a spiral, not a circle
+static void test_spiral_is_not_rotation(void) {
+    Pt p[128];
+    size_t n = arc(p, 128, 100, 180, 300, 5, 50);
+    Gesture g = replay(p, n, p[n - 1].t + 5);
+    TEST_ASSERT_NOT_EQUAL(Gesture::Rotate, g.kind);
+}
+
+// a stroke through the middle flips the angle by 180 without turning
+static void test_line_through_centre_is_a_swipe(void) {
+    Pt p[32];
+    size_t n = 0;
+    for (int x = 30; x <= 210; x += 12) p[n++] = {(uint16_t)(n * 10), (int16_t)x, (int16_t)(118 + (x & 3))};
+    Gesture g = replay(p, n, p[n - 1].t + 5);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::SwipeRight, g.kind);
+}
+
+static void test_angle_accuracy(void) {
+    int32_t worst = 0;
+    for (int d10 = 0; d10 < 3600; d10++) {
+        float a = d10 * (float)M_PI / 1800.0f;
+        int32_t dx = lroundf(1000 * cosf(a)), dy = lroundf(1000 * sinf(a));
+        int32_t want = lroundf(atan2f((float)dy, (float)dx) / (2 * (float)M_PI) * 65536.0f) & 0xFFFF;
+        int32_t err = (int16_t)(uint16_t)(GestureRecognizer::angle(dx, dy) - want);
+        if (err < 0) err = -err;
+        if (err > worst) worst = err;
+    }
+    char msg[64];
+    snprintf(msg, sizeof(msg), "worst angle error %.3f deg", worst * 360.0 / 65536.0);
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_THAN(46, worst);   // 0.25 deg
+}
+
+static void test_up_without_down_is_nothing(void) {
+    TEST_ASSERT_EQUAL_UINT8(Gesture::None, rec.up(5000).kind);
+    TEST_ASSERT_EQUAL_UINT8(Gesture::None, rec.tick(9000).kind);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_tap);
+    RUN_TEST(test_long_press_fires_once_from_tick);
+    RUN_TEST(test_swipes);
+    RUN_TEST(test_rotate_both_ways);
+    RUN_TEST(test_short_arc_is_a_swipe);
+    RUN_TEST(test_spiral_is_not_rotation);
+    RUN_TEST(test_line_through_centre_is_a_swipe);
+    RUN_TEST(test_angle_accuracy);
+    RUN_TEST(test_up_without_down_is_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,176 @@
+#include <unity.h>
+
+#include "KeyMachine.h"
+
+// {longMs, doubleMs, repeatDelayMs, repeatStartMs, repeatMinMs, repeatStepPct}, as in BtnCfg
+static constexpr KeySpec KEYS[4] = {
+    {450, 0, 0, 0, 0, 0},       // plain
+    {450, 300, 0, 0, 0, 0},     // double
+    {0, 0, 400, 250, 60, 15},   // repeat
+    {0, 0, 0, 0, 0, 0},         // click only
+};
+enum : uint8_t { PLAIN, DOUBLE, REPEAT, BARE };
+
+struct Fired {
+    uint8_t key;
+    KeyEvent ev;
+    uint32_t tUs;
+};
+
+static Fired fired[64];
+static uint8_t nFired;
+static KeyMachine<4> km(KEYS);
+
+static void record(uint8_t k, KeyEvent e, uint32_t t) {
+    if (nFired < 64) fired[nFired++] = {k, e, t};
+}
+
+static uint32_t ms(uint32_t v) { return v * 1000u; }
+
+// ticks every 5 ms, the loop cadence while keys are busy, from..to inclusive
+static void runTicks(uint32_t fromUs, uint32_t toUs) {
+    for (uint32_t t = fromUs; (int32_t)(toUs - t) >= 0; t += ms(5)) km.tick(t, record);
+}
+
+static void press(uint8_t k, uint32_t tUs) { km.edge(k, true, tUs, record); }
+static void release(uint8_t k, uint32_t tUs) { km.edge(k, false, tUs, record); }
+
+static void assertFired(uint8_t i, uint8_t k, KeyEvent e, uint32_t tUs) {
+    TEST_ASSERT_TRUE(i < nFired);
+    TEST_ASSERT_EQUAL_UINT8(k, fired[i].key);
+    TEST_ASSERT_EQUAL_INT((int)e, (int)fired[i].ev);
+    TEST_ASSERT_EQUAL_UINT32(tUs, fired[i].tUs);
+}
+
+void setUp(void) {
+    km.reset(0, 0);
+    nFired = 0;
+}
+void tearDown(void) {}
+
+static void test_plain_click_and_long(void) {
+    press(PLAIN, ms(100));
+    release(PLAIN, ms(200));
+    press(PLAIN, ms(1000));
+    release(PLAIN, ms(1450));   // exactly longMs counts as long
+
+    TEST_ASSERT_EQUAL_UINT8(2, nFired);
+    assertFired(0, PLAIN, KeyEvent::Click, ms(200));
+    assertFired(1, PLAIN, KeyEvent::Long, ms(1450));
+}
+
+static void test_double_click_inside_window(void) {
+    press(DOUBLE, ms(100));
+    release(DOUBLE, ms(150));
+    runTicks(ms(150), ms(300));
+    press(DOUBLE, ms(300));
+    release(DOUBLE, ms(360));
+    runTicks(ms(360), ms(1000));
+
+    TEST_ASSERT_EQUAL_UINT8(1, nFired);
+    assertFired(0, DOUBLE, KeyEvent::Double, ms(360));
+}
+
+static void test_single_click_fires_when_window_ends(void) {
+    press(DOUBLE, ms(100));
+    release(DOUBLE, ms(150));
+    runTicks(ms(150), ms(1000));
+
+    TEST_ASSERT_EQUAL_UINT8(1, nFired);
+    assertFired(0, DOUBLE, KeyEvent::Click, ms(150));   // stamped at the release
+}
+
+// loop stalled past the window: the late second press is not a double click
+static void test_late_second_press_without_tick(void) {
+    press(DOUBLE, ms(100));
+    release(DOUBLE, ms(150));
+    runTicks(ms(150), ms(400));         // last tick at 400, window ends at 450
+    press(DOUBLE, ms(600));
+    release(DOUBLE, ms(650));
+    runTicks(ms(650), ms(1200));
+
+    TEST_ASSERT_EQUAL_UINT8(2, nFired);
+    assertFired(0, DOUBLE, KeyEvent::Click, ms(150));
+    assertFired(1, DOUBLE, KeyEvent::Click, ms(650));
+}
+
+static void test_double_key_long_press(void) {
+    press(DOUBLE, ms(100));
+    release(DOUBLE, ms(700));
+    runTicks(ms(700), ms(1500));
+
+    TEST_ASSERT_EQUAL_UINT8(1, nFired);
+    assertFired(0, DOUBLE, KeyEvent::Long, ms(700));
+}
+
+static void test_repeat_accelerates_to_floor(void) {
+    press(REPEAT, ms(0));
+    runTicks(ms(0), ms(3000));
+    release(REPEAT, ms(3000));
+    runTicks(ms(3000), ms(4000));
+
+    assertFired(0, REPEAT, KeyEvent::Click, ms(0));
+    assertFired(1, REPEAT, KeyEvent::Repeat, ms(400));
+    assertFired(2, REPEAT, KeyEvent::Repeat, ms(650));      // 250 ms
+
+    uint32_t prevGap = ms(250);
+    for (uint8_t i = 3; i < nFired; i++) {
+        TEST_ASSERT_EQUAL_INT((int)KeyEvent::Repeat, (int)fired[i].ev);
+        uint32_t gap = fired[i].tUs - fired[i - 1].tUs;
+        TEST_ASSERT_LESS_OR_EQUAL(prevGap, gap);            // never slows down
+        TEST_ASSERT_GREATER_OR_EQUAL(ms(60), gap);          // floor, on the 5 ms tick grid
+        prevGap = gap;
+    }
+    TEST_ASSERT_EQUAL_UINT32(ms(60), fired[nFired - 1].tUs - fired[nFired - 2].tUs);
+    TEST_ASSERT_LESS_OR_EQUAL(ms(3000), fired[nFired - 1].tUs);
+}
+
+static void test_bare_key_clicks_on_release_only(void) {
+    press(BARE, ms(10));
+    runTicks(ms(10), ms(2000));
+    release(BARE, ms(2000));
+
+    TEST_ASSERT_EQUAL_UINT8(1, nFired);
+    assertFired(0, BARE, KeyEvent::Click, ms(2000));
+}
+
+// held at boot: plain keys release as a press, repeat keys stay quiet
+static void test_reset_with_keys_held(void) {
+    km.reset((1u << PLAIN) | (1u << REPEAT), ms(0));
+    runTicks(ms(0), ms(2000));
+    release(PLAIN, ms(100));
+    release(REPEAT, ms(2000));
+
+    TEST_ASSERT_EQUAL_UINT8(1, nFired);
+    assertFired(0, PLAIN, KeyEvent::Click, ms(100));
+}
+
+static void test_timestamps_wrap(void) {
+    uint32_t t0 = 0xFFFFFFFFu - ms(100);
+    km.reset(0, t0);
+    press(PLAIN, t0);
+    release(PLAIN, t0 + ms(500));       // wraps past zero
+    press(DOUBLE, t0);
+    release(DOUBLE, t0 + ms(50));
+    runTicks(t0 + ms(50), t0 + ms(200));
+    press(DOUBLE, t0 + ms(200));
+    release(DOUBLE, t0 + ms(250));
+
+    TEST_ASSERT_EQUAL_UINT8(2, nFired);
+    assertFired(0, PLAIN, KeyEvent::Long, t0 + ms(500));
+    assertFired(1, DOUBLE, KeyEvent::Double, t0 + ms(250));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_plain_click_and_long);
+    RUN_TEST(test_double_click_inside_window);
+    RUN_TEST(test_single_click_fires_when_window_ends);
+    RUN_TEST(test_late_second_press_without_tick);
+    RUN_TEST(test_double_key_long_press);
+    RUN_TEST(test_repeat_accelerates_to_floor);
+    RUN_TEST(test_bare_key_clicks_on_release_only);
+    RUN_TEST(test_reset_with_keys_held);
+    RUN_TEST(test_timestamps_wrap);
+    return UNITY_END();
+}
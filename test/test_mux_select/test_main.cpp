@@ -0,0 +1,102 @@
+#include <unity.h>
+
+#include "MuxSelect.h"
+
+// Output register of a GPIO bank with set/clear registers, one entry per write
+struct MockPort {
+    static uint32_t out;
+    static uint32_t writes;
+
+    static void set(uint32_t m) { out |= m; writes++; }
+    static void clear(uint32_t m) { out &= ~m; writes++; }
+};
+uint32_t MockPort::out = 0;
+uint32_t MockPort::writes = 0;
+
+// Pins::MUX_S0..S3
+using Sel = MuxSelect<MockPort, 15, 2, 18, 19>;
+static constexpr uint32_t SEL_LINES = (1u << 15) | (1u << 2) | (1u << 18) | (1u << 19);
+
+// select value the 4067 sees on the mock port
+static uint8_t seen() {
+    uint32_t o = MockPort::out;
+    return (uint8_t)(((o >> 15) & 1) | (((o >> 2) & 1) << 1) | (((o >> 18) & 1) << 2) | (((o >> 19) & 1) << 3));
+}
+
+static Sel sel;
+
+void setUp(void) {
+    MockPort::out = 0xFFFFFFFFu;    // garbage on the select lines and neighbours
+    MockPort::writes = 0;
+    sel = Sel();
+}
+void tearDown(void) {}
+
+static void test_reset_drives_every_line(void) {
+    sel.reset(0);
+    TEST_ASSERT_EQUAL_UINT8(0, seen());
+    TEST_ASSERT_EQUAL_HEX32(~SEL_LINES, MockPort::out);     // other pins untouched
+
+    sel.reset(0xA);
+    TEST_ASSERT_EQUAL_UINT8(0xA, seen());
+    TEST_ASSERT_EQUAL_UINT8(0xA, sel.current());
+}
+
+static void test_gray_scan_flips_one_line_per_step(void) {
+    sel.reset(0);
+    MockPort::writes = 0;
+
+    uint16_t visited = 0;
+    uint8_t prev = seen();
+    for (uint8_t i = 0; i < 16; i++) {
+        uint8_t ch = Sel::scanChannel(i);
+        uint32_t w0 = MockPort::writes;
+        sel.select(ch);
+
+        TEST_ASSERT_EQUAL_UINT8(ch, seen());
+        TEST_ASSERT_EQUAL_UINT32(i ? 1 : 0, MockPort::writes - w0);
+        TEST_ASSERT_EQUAL_INT(i ? 1 : 0, __builtin_popcount(prev ^ ch));
+        visited |= (uint16_t)(1u << ch);
+        prev = ch;
+    }
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, visited);
+    TEST_ASSERT_EQUAL_UINT32(15, MockPort::writes);
+
+    // next scan starts where this one ended: 8 -> 0 is one line as well
+    uint32_t w0 = MockPort::writes;
+    sel.select(Sel::scanChannel(0));
+    TEST_ASSERT_EQUAL_UINT32(1, MockPort::writes - w0);
+}
+
+// arbitrary jumps: one set and one clear write at most, none for no change
+static void test_any_jump_takes_at_most_two_writes(void) {
+    sel.reset(0);
+    for (uint8_t from = 0; from < 16; from++) {
+        for (uint8_t to = 0; to < 16; to++) {
+            sel.select(from);
+            uint32_t w0 = MockPort::writes;
+            sel.select(to);
+            TEST_ASSERT_EQUAL_UINT8(to, seen());
+            TEST_ASSERT_LESS_OR_EQUAL(2, MockPort::writes - w0);
+            if (from == to) TEST_ASSERT_EQUAL_UINT32(0, MockPort::writes - w0);
+        }
+    }
+}
+
+static void test_lines_maps_bits_to_pins(void) {
+    TEST_ASSERT_EQUAL_HEX32(0, Sel::lines(0));
+    TEST_ASSERT_EQUAL_HEX32(1u << 15, Sel::lines(1));
+    TEST_ASSERT_EQUAL_HEX32(1u << 2, Sel::lines(2));
+    TEST_ASSERT_EQUAL_HEX32(1u << 18, Sel::lines(4));
+    TEST_ASSERT_EQUAL_HEX32(1u << 19, Sel::lines(8));
+    TEST_ASSERT_EQUAL_HEX32(SEL_LINES, Sel::lines(15));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_reset_drives_every_line);
+    RUN_TEST(test_gray_scan_flips_one_line_per_step);
+    RUN_TEST(test_any_jump_takes_at_most_two_writes);
+    RUN_TEST(test_lines_maps_bits_to_pins);
+    return UNITY_END();
+}
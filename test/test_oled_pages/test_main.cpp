@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include <unity.h>
+
+#include "OledPages.h"
+
+// Records what would go over I2C; each transaction starts with the address
+struct FakeWire {
+    std::vector<std::vector<uint8_t>> tx;
+    std::vector<uint32_t> clocks;
+    bool open = false;
+
+    void setClock(uint32_t hz) { clocks.push_back(hz); }
+    void beginTransmission(uint8_t addr) {
+        TEST_ASSERT_FALSE(open);
+        open = true;
+        tx.push_back({addr});
+    }
+    size_t write(uint8_t b) {
+        TEST_ASSERT_TRUE(open);
+        tx.back().push_back(b);
+        return 1;
+    }
+    size_t write(const uint8_t* d, size_t n) {
+        for (size_t i = 0; i < n; i++) write(d[i]);
+        return n;
+    }
+    uint8_t endTransmission() {
+        TEST_ASSERT_TRUE(open);
+        open = false;
+        return 0;
+    }
+
+    uint32_t bytes() const {
+        uint32_t n = 0;
+        for (const auto& t : tx) n += (uint32_t)t.size();
+        return n;
+    }
+    void clear() { tx.clear(); clocks.clear(); }
+};
+
+static constexpr uint8_t ADDR = 0x3C;
+static constexpr uint8_t CHUNK = 31;
+
+static uint8_t fb[128 * 8];
+static OledPageFlusher pages;
+static FakeWire wire;
+
+void setUp(void) {
+    memset(fb, 0, sizeof(fb));
+    pages = OledPageFlusher();
+    pages.begin(128, 64, ADDR, 400000, 100000, CHUNK);
+    wire.clear();
+}
+void tearDown(void) {}
+
+// addressing is one command transaction, then data transactions for c0..c1
+static size_t assertPage(size_t t, uint8_t page, uint8_t c0, uint8_t c1) {
+    const std::vector<uint8_t> cmd = {ADDR, 0x00, 0x22, page, page, 0x21, c0, c1};
+    TEST_ASSERT_TRUE(t < wire.tx.size());
+    TEST_ASSERT_EQUAL_UINT32(cmd.size(), wire.tx[t].size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(cmd.data(), wire.tx[t].data(), cmd.size());
+    t++;
+
+    uint16_t col = c0;
+    while (col <= c1) {
+        uint16_t n = (uint16_t)(c1 - col + 1);
+        if (n > CHUNK) n = CHUNK;
+        TEST_ASSERT_TRUE(t < wire.tx.size());
+        TEST_ASSERT_EQUAL_UINT32(2 + n, wire.tx[t].size());
+        TEST_ASSERT_EQUAL_HEX8(0x40, wire.tx[t][1]);
+        TEST_ASSERT_EQUAL_UINT8_ARRAY(fb + page * 128 + col, wire.tx[t].data() + 2, n);
+        col += n;
+        t++;
+    }
+    return t;
+}
+
+static void assertClocked() {
+    TEST_ASSERT_EQUAL_UINT32(2, wire.clocks.size());
+    TEST_ASSERT_EQUAL_UINT32(400000, wire.clocks[0]);
+    TEST_ASSERT_EQUAL_UINT32(100000, wire.clocks[1]);
+}
+
+static void test_first_flush_sends_every_page(void) {
+    for (size_t i = 0; i < sizeof(fb); i++) fb[i] = (uint8_t)(i * 7);
+
+    uint32_t sent = pages.flush(fb, wire);
+
+    size_t t = 0;
+    for (uint8_t p = 0; p < 8; p++) t = assertPage(t, p, 0, 127);
+    TEST_ASSERT_EQUAL_UINT32(wire.tx.size(), t);
+    TEST_ASSERT_EQUAL_UINT32(wire.bytes(), sent);
+    TEST_ASSERT_EQUAL_UINT32(8 * (8 + 5 * 2 + 128), sent);
+    assertClocked();
+}
+
+static void test_unchanged_frame_sends_nothing(void) {
+    pages.flush(fb, wire);
+    wire.clear();
+
+    TEST_ASSERT_EQUAL_UINT32(0, pages.flush(fb, wire));
+    TEST_ASSERT_EQUAL_UINT32(0, wire.tx.size());
+    TEST_ASSERT_EQUAL_UINT32(0, wire.clocks.size());
+}
+
+static void test_only_changed_columns_go_out(void) {
+    pages.flush(fb, wire);
+    wire.clear();
+
+    // T1 digit redrawn in header line 1, one log line rewritten
+    fb[1 * 128 + 88] = 0x3E;
+    fb[1 * 128 + 99] = 0x41;
+    for (int c = 0; c < 96; c++) fb[5 * 128 + c] = 0x7F;
+
+    uint32_t sent = pages.flush(fb, wire);
+    size_t t = assertPage(0, 1, 88, 99);
+    t = assertPage(t, 5, 0, 95);
+    TEST_ASSERT_EQUAL_UINT32(wire.tx.size(), t);
+    TEST_ASSERT_EQUAL_UINT32(wire.bytes(), sent);
+    assertClocked();
+
+    TEST_ASSERT_EQUAL_UINT32(2, pages.stats().flushes);
+    TEST_ASSERT_EQUAL_UINT32(8 + 2, pages.stats().pages);
+}
+
+// Typical traffic: encoder spin on T1 plus a new log line per event.
+// Old cost per page: six ssd1306_command() transactions of 3 bytes.
+static void test_event_sequence_bytes(void) {
+    pages.flush(fb, wire);
+    uint32_t full = wire.bytes();
+    wire.clear();
+
+    uint32_t sent = 0, pagesSent = 0;
+    for (int e = 0; e < 20; e++) {
+        fb[1 * 128 + 88 + (e % 12)] ^= 0x55;
+        uint8_t logPage = (uint8_t)(2 + e % 6);
+        for (int c = 0; c < 6 * (10 + e % 8); c++) fb[logPage * 128 + c] ^= (uint8_t)(e + 1);
+
+        uint32_t before = pages.stats().pages;
+        sent += pages.flush(fb, wire);
+        pagesSent += pages.stats().pages - before;
+    }
+    TEST_ASSERT_EQUAL_UINT32(wire.bytes(), sent);
+
+    uint32_t old = sent + pagesSent * (6 * 3 - OledPageFlusher::ADDR_BYTES);
+    char msg[96];
+    snprintf(msg, sizeof(msg), "20 events: %lu bytes (per-command addressing %lu, display() %lu)",
+             (unsigned long)sent, (unsigned long)old, (unsigned long)(20 * full));
+    TEST_MESSAGE(msg);
+    TEST_ASSERT_LESS_THAN(old, sent);
+}
+
+static void test_invalidate_resends_everything(void) {
+    pages.flush(fb, wire);
+    pages.invalidate();
+    wire.clear();
+
+    TEST_ASSERT_EQUAL_UINT32(8 * (8 + 5 * 2 + 128), pages.flush(fb, wire));
+}
+
+// a full frame under a one-page cap goes out a page per call, in order
+static void test_byte_cap_resumes_on_next_call(void) {
+    for (size_t i = 0; i < sizeof(fb); i++) fb[i] = (uint8_t)(i * 3 + 1);
+    const uint32_t page = 8 + 5 * 2 + 128;
+
+    for (uint8_t p = 0; p < 8; p++) {
+        wire.clear();
+        TEST_ASSERT_EQUAL_UINT32(page, pages.flush(fb, wire, 177));
+        TEST_ASSERT_EQUAL_UINT32(wire.tx.size(), assertPage(0, p, 0, 127));
+        TEST_ASSERT_EQUAL(p < 7, pages.pending());
+    }
+    TEST_ASSERT_EQUAL_UINT32(7, pages.stats().partial);
+
+    wire.clear();
+    TEST_ASSERT_EQUAL_UINT32(0, pages.flush(fb, wire, 177));
+}
+
+// small changes share a pass; a page redrawn while waiting goes out as it is now
+static void test_byte_cap_packs_small_pages(void) {
+    pages.flush(fb, wire);
+    wire.clear();
+
+    fb[0 * 128 + 5] = 1;                                    // 8 + 2 + 1
+    for (int c = 0; c < 128; c++) fb[3 * 128 + c] = 2;      // 146
+    fb[6 * 128 + 40] = 3;                                   // 8 + 2 + 1
+
+    TEST_ASSERT_EQUAL_UINT32(11, pages.flush(fb, wire, 100));
+    TEST_ASSERT_TRUE(pages.pending());
+
+    fb[6 * 128 + 41] = 4;
+    wire.clear();
+    TEST_ASSERT_EQUAL_UINT32(146, pages.flush(fb, wire, 100));
+    TEST_ASSERT_TRUE(pages.pending());
+
+    wire.clear();
+    TEST_ASSERT_EQUAL_UINT32(12, pages.flush(fb, wire, 100));
+    TEST_ASSERT_EQUAL_UINT32(wire.tx.size(), assertPage(0, 6, 40, 41));
+    TEST_ASSERT_FALSE(pages.pending());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_flush_sends_every_page);
+    RUN_TEST(test_unchanged_frame_sends_nothing);
+    RUN_TEST(test_only_changed_columns_go_out);
+    RUN_TEST(test_event_sequence_bytes);
+    RUN_TEST(test_invalidate_resends_everything);
+    RUN_TEST(test_byte_cap_resumes_on_next_call);
+    RUN_TEST(test_byte_cap_packs_small_pages);
+    return UNITY_END();
+}
@@ -0,0 +1,159 @@
+#include <string.h>
+#include <unity.h>
+
+#include "PropStore.h"
+
+// PropCfg ids; AppConfig.h pulls in Arduino.h
+static constexpr uint32_t HVAC_FUNC_TEMP = 268828928;
+static constexpr uint32_t FB_FAN_LEVEL = 0xFB000003;
+
+static PropStore ps;
+
+void setUp() { ps = PropStore(); }
+void tearDown() {}
+
+static void test_set_and_get() {
+    TEST_ASSERT_NULL(ps.get(HVAC_FUNC_TEMP, 1));
+    TEST_ASSERT_EQUAL_UINT8(PropStore::NONE, ps.find(HVAC_FUNC_TEMP, 1));
+
+    PropStore::Ref r = ps.setFixed(HVAC_FUNC_TEMP, 1, 2250);
+    TEST_ASSERT_NOT_EQUAL(PropStore::NONE, r);
+    TEST_ASSERT_EQUAL_UINT8(r, ps.find(HVAC_FUNC_TEMP, 1));
+
+    const PropStore::Value* v = ps.get(r);
+    TEST_ASSERT_NOT_NULL(v);
+    TEST_ASSERT_TRUE(v->type == PropStore::Type::Fixed);
+    TEST_ASSERT_EQUAL_INT32(2250, v->i);
+
+    // areas are separate entries
+    PropStore::Ref r4 = ps.setFixed(HVAC_FUNC_TEMP, 4, 2100);
+    TEST_ASSERT_NOT_EQUAL(r, r4);
+    TEST_ASSERT_EQUAL_INT32(2250, ps.get(HVAC_FUNC_TEMP, 1)->i);
+    TEST_ASSERT_EQUAL_INT32(2100, ps.get(HVAC_FUNC_TEMP, 4)->i);
+
+    // same key, same slot; the type follows the last set
+    TEST_ASSERT_EQUAL_UINT8(r, ps.setInt(HVAC_FUNC_TEMP, 1, 7));
+    TEST_ASSERT_TRUE(ps.get(r)->type == PropStore::Type::Int);
+    TEST_ASSERT_EQUAL_UINT8(2, ps.stats().count);
+
+    TEST_ASSERT_NULL(ps.get(PropStore::NONE));
+}
+
+static void test_only_real_changes_count() {
+    ps.setInt(1, 0, 5);
+    ps.setInt(1, 0, 5);
+    ps.setFixed(1, 0, 5);       // same bits, other type
+    ps.setText(2, 0, "L3", 2);
+    ps.setText(2, 0, "L3", 2);
+    ps.setText(2, 0, "L", 1);   // prefix of the old text
+    TEST_ASSERT_EQUAL_UINT32(6, ps.stats().sets);
+    TEST_ASSERT_EQUAL_UINT32(4, ps.stats().changes);
+    TEST_ASSERT_EQUAL_STRING("L", ps.get(2, 0)->text);
+}
+
+static void test_text_is_truncated_and_needs_no_terminator() {
+    const char raw[] = {'A', 'U', 'T', 'O', 'X'};
+    ps.setText(FB_FAN_LEVEL, 8, raw, 4);
+    TEST_ASSERT_EQUAL_STRING("AUTO", ps.get(FB_FAN_LEVEL, 8)->text);
+
+    const char* longText = "0123456789ABCDEF";
+    ps.setText(FB_FAN_LEVEL, 8, longText, strlen(longText));
+    const PropStore::Value* v = ps.get(FB_FAN_LEVEL, 8);
+    TEST_ASSERT_EQUAL(PropStore::TEXT_LEN - 1, strlen(v->text));
+    TEST_ASSERT_EQUAL_MEMORY(longText, v->text, PropStore::TEXT_LEN - 1);
+
+    // the truncated text again is no change
+    uint32_t changes = ps.stats().changes;
+    ps.setText(FB_FAN_LEVEL, 8, longText, strlen(longText));
+    TEST_ASSERT_EQUAL_UINT32(changes, ps.stats().changes);
+}
+
+static void test_watchers_see_their_changes_only() {
+    uint8_t header = ps.subscribe();
+    uint8_t fan = ps.subscribe();
+    TEST_ASSERT_TRUE(ps.watch(header, HVAC_FUNC_TEMP, 1));
+    TEST_ASSERT_TRUE(ps.watch(fan, FB_FAN_LEVEL));
+
+    PropStore::Ref t1 = ps.setFixed(HVAC_FUNC_TEMP, 1, 2250);
+    PropStore::Ref t4 = ps.setFixed(HVAC_FUNC_TEMP, 4, 2100);   // area not watched
+    PropStore::Ref f8 = ps.setText(FB_FAN_LEVEL, 8, "L3", 2);
+    PropStore::Ref f2 = ps.setText(FB_FAN_LEVEL, 2, "L1", 2);
+
+    TEST_ASSERT_TRUE(ps.poll(header));
+    TEST_ASSERT_FALSE(ps.poll(header));
+    TEST_ASSERT_TRUE(ps.take(header, t1));
+    TEST_ASSERT_FALSE(ps.take(header, t1));
+    TEST_ASSERT_FALSE(ps.take(header, t4));
+    TEST_ASSERT_FALSE(ps.take(header, f8));
+
+    TEST_ASSERT_TRUE(ps.poll(fan));
+    TEST_ASSERT_TRUE(ps.take(fan, f8));
+    TEST_ASSERT_TRUE(ps.take(fan, f2));
+    TEST_ASSERT_FALSE(ps.take(fan, t1));
+
+    // an unchanged set wakes nobody
+    ps.setFixed(HVAC_FUNC_TEMP, 1, 2250);
+    TEST_ASSERT_FALSE(ps.poll(header));
+    ps.setFixed(HVAC_FUNC_TEMP, 1, 2300);
+    TEST_ASSERT_TRUE(ps.poll(header));
+    TEST_ASSERT_FALSE(ps.poll(fan));
+    TEST_ASSERT_TRUE(ps.take(header, t1));
+
+    TEST_ASSERT_FALSE(ps.take(header, PropStore::NONE));
+}
+
+static void test_late_watch_starts_dirty() {
+    PropStore::Ref r = ps.setFixed(HVAC_FUNC_TEMP, 1, 2250);
+    ps.setFixed(HVAC_FUNC_TEMP, 4, 2100);
+
+    uint8_t s = ps.subscribe();
+    TEST_ASSERT_TRUE(ps.watch(s, HVAC_FUNC_TEMP, 1));
+    TEST_ASSERT_TRUE(ps.poll(s));
+    TEST_ASSERT_TRUE(ps.take(s, r));
+    TEST_ASSERT_FALSE(ps.take(s, ps.find(HVAC_FUNC_TEMP, 4)));
+}
+
+static void test_subscriber_and_watch_limits() {
+    for (uint8_t i = 0; i < PropStore::MAX_SUBS; i++) TEST_ASSERT_EQUAL_UINT8(i, ps.subscribe());
+    TEST_ASSERT_EQUAL_UINT8(PropStore::MAX_SUBS, ps.subscribe());
+    TEST_ASSERT_FALSE(ps.watch(PropStore::MAX_SUBS, 1));
+
+    for (uint8_t i = 0; i < PropStore::MAX_WATCH; i++) TEST_ASSERT_TRUE(ps.watch(0, 100 + i));
+    TEST_ASSERT_FALSE(ps.watch(0, 999));
+}
+
+// One slot stays free so a lookup that misses always ends
+static void test_full_table() {
+    for (uint32_t id = 0; id < PropStore::CAPACITY - 1; id++) {
+        TEST_ASSERT_NOT_EQUAL(PropStore::NONE, ps.setInt(id, (int32_t)id, (int32_t)id));
+    }
+    TEST_ASSERT_EQUAL_UINT8(PropStore::CAPACITY - 1, ps.stats().count);
+
+    TEST_ASSERT_EQUAL_UINT8(PropStore::NONE, ps.setInt(1000, 0, 1));
+    TEST_ASSERT_EQUAL_UINT32(1, ps.stats().full);
+    TEST_ASSERT_EQUAL_UINT8(PropStore::NONE, ps.find(1000, 0));
+    TEST_ASSERT_NULL(ps.get(1000, 0));
+
+    // known keys still update
+    TEST_ASSERT_NOT_EQUAL(PropStore::NONE, ps.setInt(5, 5, 50));
+    TEST_ASSERT_EQUAL_INT32(50, ps.get(5, 5)->i);
+
+    for (uint32_t id = 0; id < PropStore::CAPACITY - 1; id++) {
+        const PropStore::Value* v = ps.get(id, (int32_t)id);
+        TEST_ASSERT_NOT_NULL(v);
+        TEST_ASSERT_EQUAL_INT32(id == 5 ? 50 : (int32_t)id, v->i);
+    }
+    TEST_ASSERT_TRUE(ps.stats().maxProbe < PropStore::CAPACITY);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_set_and_get);
+    RUN_TEST(test_only_real_changes_count);
+    RUN_TEST(test_text_is_truncated_and_needs_no_terminator);
+    RUN_TEST(test_watchers_see_their_changes_only);
+    RUN_TEST(test_late_watch_starts_dirty);
+    RUN_TEST(test_subscriber_and_watch_limits);
+    RUN_TEST(test_full_table);
+    return UNITY_END();
+}
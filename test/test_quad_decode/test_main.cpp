@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <unity.h>
+
+#include "QuadDecode.h"
+
+// AiEsp32RotaryEncoder::readEncoder_ISR(), index = (oldB oldA newB newA)
+static const int8_t kLibStates[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+
+// PCNT unit as PcntEncoder configures it: QuadDecode edges, reset to 0 at +-limit
+struct MockPcnt {
+    int16_t limit;
+    int16_t counter = 0;
+    uint8_t ab = 0;
+
+    void pins(uint8_t next) {
+        int32_t c = counter + QuadDecode::count(ab, next);
+        if (c >= limit || c <= -limit) c = 0;
+        counter = (int16_t)c;
+        ab = next;
+    }
+};
+
+// What the library sees on the same pins
+struct MockLib {
+    uint8_t oldAB = 0;
+    long pos = 0;
+
+    void pins(uint8_t next) {
+        oldAB = (uint8_t)(((oldAB << 2) | next) & 0x0F);
+        pos += kLibStates[oldAB];
+    }
+};
+
+// A leads B: 00 -> 01 -> 11 -> 10 -> 00 (AB = (B << 1) | A)
+static const uint8_t kALeads[4] = {1, 3, 2, 0};
+static const uint8_t kBLeads[4] = {2, 3, 1, 0};
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_every_transition_matches_library(void) {
+    for (uint8_t o = 0; o < 4; o++) {
+        for (uint8_t n = 0; n < 4; n++) {
+            if (((o ^ n) & 3) == 3) continue;   // both pins at once: not a step
+            char msg[32];
+            snprintf(msg, sizeof(msg), "AB %u -> %u", o, n);
+            TEST_ASSERT_EQUAL_INT_MESSAGE(kLibStates[(o << 2) | n], QuadDecode::count(o, n), msg);
+        }
+    }
+}
+
+// a knob turned the same way moves both backends the same way
+static void test_turn_direction_matches_library(void) {
+    MockPcnt pcnt{30000};
+    MockLib lib;
+    QuadDecode::Unwrap unwrap(30000, 4);
+
+    for (int d = 0; d < 5; d++) {
+        for (uint8_t s : kALeads) { pcnt.pins(s); lib.pins(s); }
+    }
+    TEST_ASSERT_EQUAL_INT(-20, pcnt.counter);
+    TEST_ASSERT_EQUAL_INT(lib.pos, pcnt.counter);
+    TEST_ASSERT_EQUAL_INT(-5, unwrap.update(pcnt.counter));
+
+    for (int d = 0; d < 7; d++) {
+        for (uint8_t s : kBLeads) { pcnt.pins(s); lib.pins(s); }
+    }
+    TEST_ASSERT_EQUAL_INT(lib.pos, pcnt.counter);
+    TEST_ASSERT_EQUAL_INT(2, unwrap.update(pcnt.counter));
+}
+
+// contact chatter on one pin goes back and forth and nets nothing
+static void test_chatter_cancels(void) {
+    MockPcnt pcnt{30000};
+    for (int i = 0; i < 9; i++) pcnt.pins((i & 1) ? 0 : 1);
+    TEST_ASSERT_EQUAL_INT(-1, pcnt.counter);    // ends one edge in, A high
+    pcnt.pins(0);
+    TEST_ASSERT_EQUAL_INT(0, pcnt.counter);
+}
+
+// fast spin through many counter resets, polled well inside limit/2
+static void test_unwrap_across_resets(void) {
+    MockPcnt pcnt{30000};
+    QuadDecode::Unwrap unwrap(30000, 4);
+
+    long detents = 0;
+    for (long step = 0; step < 4L * 50000; step++) {
+        pcnt.pins(kBLeads[step & 3]);
+        if (step % 997 == 0) detents = unwrap.update(pcnt.counter);
+    }
+    detents = unwrap.update(pcnt.counter);
+    TEST_ASSERT_EQUAL_INT(4L * 50000, unwrap.counts());
+    TEST_ASSERT_EQUAL_INT(50000, detents);
+
+    for (long step = 0; step < 4L * 80000; step++) {
+        pcnt.pins(kALeads[step & 3]);
+        if (step % 1999 == 0) unwrap.update(pcnt.counter);
+    }
+    TEST_ASSERT_EQUAL_INT(-30000, unwrap.update(pcnt.counter));
+}
+
+static void test_detents_floor_around_zero(void) {
+    QuadDecode::Unwrap unwrap(30000, 4);
+    const int16_t raw[]  = {0, 3, 4, 7, 8, -1, -4, -5, -8, -9};
+    const long want[]    = {0, 0, 1, 1, 2, -1, -1, -2, -2, -3};
+    for (size_t i = 0; i < sizeof(raw) / sizeof(raw[0]); i++) {
+        TEST_ASSERT_EQUAL_INT(want[i], unwrap.update(raw[i]));
+    }
+
+    unwrap.reset();
+    TEST_ASSERT_EQUAL_INT(0, unwrap.update(0));
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_transition_matches_library);
+    RUN_TEST(test_turn_direction_matches_library);
+    RUN_TEST(test_chatter_cancels);
+    RUN_TEST(test_unwrap_across_resets);
+    RUN_TEST(test_detents_floor_around_zero);
+    return UNITY_END();
+}
@@ -0,0 +1,464 @@
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+#include <vector>
+
+#include "RxParser.h"
+
+using namespace RxParser;
+
+// Handlers shaped like main.cpp's: they log a line per message into out
+static char out[64];
+static uint32_t outLines;
+static Args last;
+
+static bool hCap(const Args& a) {
+    last = a;
+    snprintf(out, sizeof(out), "CAP:1:TEXT,BIN");
+    outLines++;
+    return true;
+}
+
+static bool hMode(const Args& a) {
+    last = a;
+    bool bin = a.f[0].tok.is("BIN");
+    if (!bin && !a.f[0].tok.is("TEXT")) return false;
+    snprintf(out, sizeof(out), "%s", bin ? "MODE:BIN" : "MODE:TEXT");
+    outLines++;
+    return true;
+}
+
+static bool hRear(const Args& a) {
+    last = a;
+    snprintf(out, sizeof(out), "REAR_DEF:%s", a.f[0].i == 1 ? "ON" : "OFF");
+    outLines++;
+    return true;
+}
+
+static bool hElectric(const Args& a) {
+    last = a;
+    snprintf(out, sizeof(out), "E_DEF:%s", a.f[0].i == 1 ? "ON" : "OFF");
+    outLines++;
+    return true;
+}
+
+static bool hFan(const Args& a) {
+    last = a;
+    const Token& t = a.f[1].tok;
+    snprintf(out, sizeof(out), "FAN:%ld:%.*s", (long)a.f[0].i, t.n ? (int)t.n : 1, t.n ? t.p : "?");
+    outLines++;
+    return true;
+}
+
+static bool hGibFloat(const Args& a) {
+    last = a;
+    if (a.f[0].i < 0) return false;
+    char num[16];
+    if (a.f[0].i == 268828928) {
+        formatFixed(num, sizeof(num), a.f[2].i, 1);
+        snprintf(out, sizeof(out), "TEMP:%ld:%s", (long)a.f[1].i, num);
+    } else {
+        formatFixed(num, sizeof(num), a.f[2].i, 2);
+        snprintf(out, sizeof(out), "F:%ld:%ld:%s", (long)a.f[0].i, (long)a.f[1].i, num);
+    }
+    outLines++;
+    return true;
+}
+
+static bool hGibInt(const Args& a) {
+    last = a;
+    if (a.f[0].i < 0) return false;
+    snprintf(out, sizeof(out), "I:%ld:%ld:%ld", (long)a.f[0].i, (long)a.f[1].i, (long)a.f[2].i);
+    outLines++;
+    return true;
+}
+
+static uint32_t fallbacks;
+
+static bool hFallback(const Args& a) {
+    last = a;
+    snprintf(out, sizeof(out), "RX:%.*s", (int)a.lineLen, a.line);
+    outLines++;
+    fallbacks++;
+    return true;
+}
+
+// kRxCommands
+static const Command kTable[] = {
+    {"CAP?",         "",    hCap},
+    {"MODE:",        "T",   hMode},
+    {"FB:REAR:",     "I",   hRear},
+    {"FB:ELECTRIC:", "I",   hElectric},
+    {"FB:FAN:",      "It",  hFan},
+    {"GIB:FLOAT:",   "IIF", hGibFloat},
+    {"GIB:INT:",     "III", hGibInt},
+};
+
+// What the phone sends, roughly in the proportions it sends them
+static const char* const kMix[] = {
+    "GIB:FLOAT:268828928:1:22.5",
+    "GIB:FLOAT:268828928:4:21",
+    "GIB:FLOAT:557842692:0:13.75",
+    "FB:FAN:8:L3",
+    "FB:FAN:8:AUTO",
+    "FB:REAR:1",
+    "FB:ELECTRIC:0",
+    "GIB:FLOAT:268828928:1:22.0",
+    "MODE:BIN",
+    "CAP?",
+    "PING",
+    "GIB:FLOAT:268828928:4:20.5",
+};
+
+void setUp() {
+    out[0] = '\0';
+    outLines = 0;
+    fallbacks = 0;
+    memset(&last, 0, sizeof(last));
+}
+void tearDown() {}
+
+// Copy into a buffer of exactly n bytes, no terminator, so ASan catches a
+// read past the end of the message
+static bool dispatchExact(Dispatcher& d, const char* s, size_t n) {
+    std::vector<char> buf(s, s + n);
+    return d.dispatch(buf.data(), n);
+}
+
+static bool dispatchStr(Dispatcher& d, const char* s) { return dispatchExact(d, s, strlen(s)); }
+
+static void test_parse_int() {
+    int32_t v = 0;
+    TEST_ASSERT_TRUE(parseInt("0", 1, &v));
+    TEST_ASSERT_EQUAL_INT32(0, v);
+    TEST_ASSERT_TRUE(parseInt("-17", 3, &v));
+    TEST_ASSERT_EQUAL_INT32(-17, v);
+    TEST_ASSERT_TRUE(parseInt("+8", 2, &v));
+    TEST_ASSERT_EQUAL_INT32(8, v);
+    TEST_ASSERT_TRUE(parseInt("2147483647", 10, &v));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, v);
+    TEST_ASSERT_TRUE(parseInt("-2147483648", 11, &v));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, v);
+
+    TEST_ASSERT_FALSE(parseInt("2147483648", 10, &v));
+    TEST_ASSERT_FALSE(parseInt("-2147483649", 11, &v));
+    TEST_ASSERT_FALSE(parseInt("", 0, &v));
+    TEST_ASSERT_FALSE(parseInt("-", 1, &v));
+    TEST_ASSERT_FALSE(parseInt("1x", 2, &v));
+    TEST_ASSERT_FALSE(parseInt(" 1", 2, &v));
+
+    // only n bytes are looked at
+    TEST_ASSERT_TRUE(parseInt("12:34", 2, &v));
+    TEST_ASSERT_EQUAL_INT32(12, v);
+}
+
+static void test_parse_fixed() {
+    int32_t v = 0;
+    TEST_ASSERT_TRUE(parseFixed("22.5", 4, &v));
+    TEST_ASSERT_EQUAL_INT32(2250, v);
+    TEST_ASSERT_TRUE(parseFixed("21", 2, &v));
+    TEST_ASSERT_EQUAL_INT32(2100, v);
+    TEST_ASSERT_TRUE(parseFixed("-0.125", 6, &v));
+    TEST_ASSERT_EQUAL_INT32(-12, v);        // extra decimals truncated
+    TEST_ASSERT_TRUE(parseFixed(".5", 2, &v));
+    TEST_ASSERT_EQUAL_INT32(50, v);
+    TEST_ASSERT_TRUE(parseFixed("5.", 2, &v));
+    TEST_ASSERT_EQUAL_INT32(500, v);
+    TEST_ASSERT_TRUE(parseFixed("21474836.47", 11, &v));
+    TEST_ASSERT_EQUAL_INT32(INT32_MAX, v);
+
+    TEST_ASSERT_FALSE(parseFixed("21474836.48", 11, &v));
+    TEST_ASSERT_FALSE(parseFixed(".", 1, &v));
+    TEST_ASSERT_FALSE(parseFixed("", 0, &v));
+    TEST_ASSERT_FALSE(parseFixed("1.2.3", 5, &v));
+    TEST_ASSERT_FALSE(parseFixed("1e3", 3, &v));
+}
+
+static void test_format_fixed() {
+    char b[16];
+    TEST_ASSERT_EQUAL(4, formatFixed(b, sizeof(b), 2250, 1));
+    TEST_ASSERT_EQUAL_STRING("22.5", b);
+    formatFixed(b, sizeof(b), -125, 2);
+    TEST_ASSERT_EQUAL_STRING("-1.25", b);
+    formatFixed(b, sizeof(b), -125, 1);
+    TEST_ASSERT_EQUAL_STRING("-1.3", b);     // half away from zero
+    formatFixed(b, sizeof(b), 5, 0);
+    TEST_ASSERT_EQUAL_STRING("0", b);
+    formatFixed(b, sizeof(b), -4, 1);
+    TEST_ASSERT_EQUAL_STRING("0.0", b);      // no "-0.0"
+    formatFixed(b, sizeof(b), INT32_MIN, 2);
+    TEST_ASSERT_EQUAL_STRING("-21474836.48", b);
+
+    // truncated, still terminated
+    TEST_ASSERT_EQUAL(3, formatFixed(b, 4, 123456, 2));
+    TEST_ASSERT_EQUAL_STRING("123", b);
+}
+
+static void test_dispatch_routes_and_splits_fields() {
+    Dispatcher d(kTable, sizeof(kTable) / sizeof(kTable[0]), hFallback);
+
+    TEST_ASSERT_TRUE(dispatchStr(d, "GIB:FLOAT:268828928:1:22.5"));
+    TEST_ASSERT_EQUAL_STRING("TEMP:1:22.5", out);
+    TEST_ASSERT_EQUAL(3, last.count);
+
+    TEST_ASSERT_TRUE(dispatchStr(d, "GIB:FLOAT:557842692:0:13.75"));
+    TEST_ASSERT_EQUAL_STRING("F:557842692:0:13.75", out);
+
+    TEST_ASSERT_TRUE(dispatchStr(d, "FB:FAN:8:L3"));
+    TEST_ASSERT_EQUAL_STRING("FAN:8:L3", out);
+
+    // optional trailing field
+    TEST_ASSERT_TRUE(dispatchStr(d, "FB:FAN:8"));
+    TEST_ASSERT_EQUAL_STRING("FAN:8:?", out);
+    TEST_ASSERT_EQUAL(1, last.count);
+    TEST_ASSERT_FALSE(last.f[1].present);
+
+    // the last token takes the rest of the line, ':' included
+    TEST_ASSERT_TRUE(dispatchStr(d, "FB:FAN:2:L3:X"));
+    TEST_ASSERT_EQUAL_STRING("FAN:2:L3:X", out);
+
+    TEST_ASSERT_TRUE(dispatchStr(d, "CAP?"));
+    TEST_ASSERT_EQUAL_STRING("CAP:1:TEXT,BIN", out);
+    TEST_ASSERT_TRUE(dispatchStr(d, "MODE:TEXT"));
+    TEST_ASSERT_EQUAL_STRING("MODE:TEXT", out);
+    TEST_ASSERT_TRUE(dispatchStr(d, "GIB:INT:557842692:2:-3"));
+    TEST_ASSERT_EQUAL_STRING("I:557842692:2:-3", out);
+
+    TEST_ASSERT_EQUAL_UINT32(8, d.stats().handled);
+    TEST_ASSERT_EQUAL_UINT32(0, fallbacks);
+}
+
+static void test_dispatch_falls_back() {
+    Dispatcher d(kTable, sizeof(kTable) / sizeof(kTable[0]), hFallback);
+
+    TEST_ASSERT_FALSE(dispatchStr(d, "PING"));
+    TEST_ASSERT_EQUAL_STRING("RX:PING", out);
+    TEST_ASSERT_FALSE(dispatchStr(d, "CAP"));           // shorter than the prefix
+    TEST_ASSERT_EQUAL_UINT32(2, d.stats().unknown);
+
+    TEST_ASSERT_FALSE(dispatchStr(d, "FB:REAR:1x"));    // atoi read 1
+    TEST_ASSERT_FALSE(dispatchStr(d, "CAP?x"));
+    TEST_ASSERT_FALSE(dispatchStr(d, "GIB:FLOAT:1:2"));
+    TEST_ASSERT_FALSE(dispatchStr(d, "GIB:FLOAT:1:2:3:4"));
+    TEST_ASSERT_EQUAL_UINT32(4, d.stats().malformed);
+    TEST_ASSERT_EQUAL_STRING("RX:GIB:FLOAT:1:2:3:4", out);
+
+    TEST_ASSERT_FALSE(dispatchStr(d, "MODE:HEX"));
+    TEST_ASSERT_FALSE(dispatchStr(d, "GIB:FLOAT:-1:0:1"));
+    TEST_ASSERT_EQUAL_UINT32(2, d.stats().rejected);
+
+    TEST_ASSERT_FALSE(d.dispatch("", 0));
+    TEST_ASSERT_EQUAL_UINT32(3, d.stats().unknown);
+    TEST_ASSERT_EQUAL_UINT32(9, fallbacks);
+    TEST_ASSERT_EQUAL_UINT32(0, d.stats().handled);
+}
+
+// A later entry with the same prefix gets a go when the schema doesn't fit
+static void test_same_prefix_tries_next_entry() {
+    static const Command table[] = {
+        {"SET:", "I", hRear},
+        {"SET:", "T", hMode},
+    };
+    Dispatcher d(table, 2, hFallback);
+
+    TEST_ASSERT_TRUE(dispatchStr(d, "SET:1"));
+    TEST_ASSERT_EQUAL_STRING("REAR_DEF:ON", out);
+    TEST_ASSERT_TRUE(dispatchStr(d, "SET:BIN"));
+    TEST_ASSERT_EQUAL_STRING("MODE:BIN", out);
+    TEST_ASSERT_EQUAL_UINT32(2, d.stats().handled);
+    TEST_ASSERT_EQUAL_UINT32(0, d.stats().malformed);
+}
+
+// One byte of a known message changed, dropped, inserted or cut off
+static size_t mutate(char* buf, size_t cap, const char* src) {
+    size_t n = strlen(src);
+    memcpy(buf, src, n);
+    int edits = 1 + rand() % 3;
+    for (int k = 0; k < edits; k++) {
+        size_t at = n ? (size_t)rand() % n : 0;
+        static const char kBytes[] = "0123456789:-+.?ABFGILMNOTX\n\0\xff";
+        char c = kBytes[rand() % (sizeof(kBytes) - 1)];
+        switch (rand() % 4) {
+            case 0: if (n) buf[at] = c; break;
+            case 1: if (n) { memmove(buf + at, buf + at + 1, n - at - 1); n--; } break;
+            case 2: if (n < cap) { memmove(buf + at + 1, buf + at, n - at); buf[at] = c; n++; } break;
+            case 3: n = at; break;
+        }
+    }
+    return n;
+}
+
+static void test_fuzz() {
+    Dispatcher d(kTable, sizeof(kTable) / sizeof(kTable[0]), hFallback);
+    srand(24024);
+
+    const uint32_t N = 200000;
+    char buf[300];
+    for (uint32_t i = 0; i < N; i++) {
+        size_t n;
+        if (i & 1) {
+            n = mutate(buf, sizeof(buf), kMix[rand() % (sizeof(kMix) / sizeof(kMix[0]))]);
+        } else {
+            // random bytes, sometimes longer than a uint8_t length
+            n = (size_t)rand() % sizeof(buf);
+            for (size_t k = 0; k < n; k++) buf[k] = (char)rand();
+            if (n > 4 && (rand() & 1)) memcpy(buf, "GIB:", 4);
+        }
+
+        memset(&last, 0, sizeof(last));
+        dispatchExact(d, buf, n);
+
+        // every field the handler saw points inside the message
+        TEST_ASSERT_TRUE(last.count <= MAX_FIELDS);
+        for (uint8_t k = 0; k < last.count; k++) {
+            const Field& f = last.f[k];
+            if (!f.present) continue;
+            TEST_ASSERT_TRUE(f.tok.p >= last.line);
+            TEST_ASSERT_TRUE(f.tok.p + f.tok.n <= last.line + n);
+        }
+    }
+
+    const Stats& s = d.stats();
+    TEST_ASSERT_EQUAL_UINT32(N, s.handled + s.unknown + s.malformed + s.rejected);
+    TEST_ASSERT_EQUAL_UINT32(s.unknown + s.malformed + s.rejected, fallbacks);
+    TEST_ASSERT_EQUAL_UINT32(N, outLines);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%lu handled, %lu unknown, %lu malformed, %lu rejected",
+             (unsigned long)s.handled, (unsigned long)s.unknown,
+             (unsigned long)s.malformed, (unsigned long)s.rejected);
+    TEST_MESSAGE(msg);
+}
+
+// ---- the strncmp / atoi chain RxParser replaced, outputs into out ----
+static void oldProcessRx(const char* s) {
+    if (strcmp(s, "CAP?") == 0) {
+        snprintf(out, sizeof(out), "CAP:1:TEXT,BIN");
+        outLines++;
+        return;
+    }
+    if (strncmp(s, "MODE:", 5) == 0) {
+        bool bin = (strcmp(s + 5, "BIN") == 0);
+        if (!bin && strcmp(s + 5, "TEXT") != 0) goto fallback;
+        snprintf(out, sizeof(out), "%s", bin ? "MODE:BIN" : "MODE:TEXT");
+        outLines++;
+        return;
+    }
+    if (strncmp(s, "FB:REAR:", 8) == 0) {
+        int v = atoi(s + 8);
+        snprintf(out, sizeof(out), "REAR_DEF:%s", (v == 1 ? "ON" : "OFF"));
+        outLines++;
+        return;
+    }
+    if (strncmp(s, "FB:ELECTRIC:", 12) == 0) {
+        int v = atoi(s + 12);
+        snprintf(out, sizeof(out), "E_DEF:%s", (v == 1 ? "ON" : "OFF"));
+        outLines++;
+        return;
+    }
+    if (strncmp(s, "FB:FAN:", 7) == 0) {
+        static char fanLevel[12];
+        const char* p = s + 7;
+        int area = atoi(p);
+        const char* c1 = strchr(p, ':');
+        if (c1 && *(c1 + 1)) {
+            strncpy(fanLevel, c1 + 1, sizeof(fanLevel) - 1);
+            fanLevel[sizeof(fanLevel) - 1] = '\0';
+        } else {
+            strncpy(fanLevel, "?", sizeof(fanLevel));
+            fanLevel[sizeof(fanLevel) - 1] = '\0';
+        }
+        snprintf(out, sizeof(out), "FAN:%d:%s", area, fanLevel);
+        outLines++;
+        return;
+    }
+    if (strncmp(s, "GIB:FLOAT:", 10) == 0) {
+        const char* p = s + 10;
+        int id = atoi(p);
+        const char* c1 = strchr(p, ':');
+        if (!c1) goto fallback;
+        int area = atoi(c1 + 1);
+        const char* c2 = strchr(c1 + 1, ':');
+        if (!c2) goto fallback;
+        float v = (float)atof(c2 + 1);
+
+        if (id == 268828928) {
+            snprintf(out, sizeof(out), "TEMP:%d:%.1f", area, v);
+        } else {
+            snprintf(out, sizeof(out), "F:%d:%d:%.2f", id, area, v);
+        }
+        outLines++;
+        return;
+    }
+
+fallback:
+    snprintf(out, sizeof(out), "RX:%s", s);
+    outLines++;
+}
+
+// Same output for the mix, so the timings below compare like with like
+static void test_matches_old_chain_on_mix() {
+    Dispatcher d(kTable, sizeof(kTable) / sizeof(kTable[0]), hFallback);
+    char want[sizeof(out)];
+    for (const char* s : kMix) {
+        oldProcessRx(s);
+        memcpy(want, out, sizeof(out));
+        dispatchStr(d, s);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(want, out, s);
+    }
+}
+
+static void test_benchmark_against_old_chain() {
+    Dispatcher d(kTable, sizeof(kTable) / sizeof(kTable[0]), hFallback);
+    const size_t M = sizeof(kMix) / sizeof(kMix[0]);
+    const uint32_t REPS = 20000;
+
+    // the old drainRx handed processRx '\0'-terminated lines in the slot
+    char lines[M][32];
+    size_t lens[M];
+    for (size_t i = 0; i < M; i++) {
+        lens[i] = strlen(kMix[i]);
+        memcpy(lines[i], kMix[i], lens[i] + 1);
+    }
+
+    using Clock = std::chrono::steady_clock;
+    double oldNs = INFINITY, newNs = INFINITY;
+    for (int round = 0; round < 3; round++) {
+        auto t0 = Clock::now();
+        for (uint32_t r = 0; r < REPS; r++) {
+            for (size_t i = 0; i < M; i++) oldProcessRx(lines[i]);
+        }
+        auto t1 = Clock::now();
+        for (uint32_t r = 0; r < REPS; r++) {
+            for (size_t i = 0; i < M; i++) d.dispatch(lines[i], lens[i]);
+        }
+        auto t2 = Clock::now();
+
+        double per = (double)REPS * M;
+        oldNs = fmin(oldNs, std::chrono::duration<double, std::nano>(t1 - t0).count() / per);
+        newNs = fmin(newNs, std::chrono::duration<double, std::nano>(t2 - t1).count() / per);
+    }
+    TEST_ASSERT_EQUAL_UINT32(2u * 3 * REPS * M, outLines);
+
+    char msg[96];
+    snprintf(msg, sizeof(msg), "%u messages: table %.0f ns/msg, strncmp chain %.0f ns/msg",
+             (unsigned)M, newNs, oldNs);
+    TEST_MESSAGE(msg);
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_parse_int);
+    RUN_TEST(test_parse_fixed);
+    RUN_TEST(test_format_fixed);
+    RUN_TEST(test_dispatch_routes_and_splits_fields);
+    RUN_TEST(test_dispatch_falls_back);
+    RUN_TEST(test_same_prefix_tries_next_entry);
+    RUN_TEST(test_fuzz);
+    RUN_TEST(test_matches_old_chain_on_mix);
+    RUN_TEST(test_benchmark_against_old_chain);
+    return UNITY_END();
+}
@@ -0,0 +1,113 @@
+#include <string.h>
+#include <string>
+#include <unity.h>
+#include <vector>
+
+#include "RxSplit.h"
+
+// RxCfg::SLOT_LEN
+static constexpr size_t SLOT_LEN = 160;
+
+void setUp() {}
+void tearDown() {}
+
+struct Split {
+    std::vector<std::string> slots;
+    unsigned cuts = 0;
+};
+
+// What onWrite() pushes into the ring for one write
+static Split split(const std::string& w, size_t cap = SLOT_LEN) {
+    Split s;
+    const char* p = w.data();
+    size_t left = w.size();
+    while (left) {
+        RxSplit::Piece pc = RxSplit::next(p, left, cap);
+        TEST_ASSERT_TRUE(pc.len <= cap);
+        TEST_ASSERT_TRUE(pc.next > 0 && pc.next <= left);
+        if (pc.cut) s.cuts++;
+        s.slots.emplace_back(p, pc.len);
+        p += pc.next;
+        left -= pc.next;
+    }
+    return s;
+}
+
+// Lines as drainRx() sees them, across all slots
+static std::vector<std::string> lines(const Split& s) {
+    std::vector<std::string> out;
+    for (const std::string& slot : s.slots) {
+        size_t i = 0;
+        while (i < slot.size()) {
+            size_t e = i;
+            while (e < slot.size() && slot[e] != '\n' && slot[e] != '\r') e++;
+            if (e > i) out.push_back(slot.substr(i, e - i));
+            i = e + 1;
+        }
+    }
+    return out;
+}
+
+static void test_short_write_is_one_slot() {
+    Split s = split("GIB:FLOAT:268828928:1:22.5\nFB:FAN:8:L3");
+    TEST_ASSERT_EQUAL(1, s.slots.size());
+    TEST_ASSERT_EQUAL(0, s.cuts);
+    TEST_ASSERT_EQUAL(2, lines(s).size());
+}
+
+// A 512-byte write of many messages keeps every one of them whole
+static void test_mtu_sized_write_keeps_every_message() {
+    std::string w;
+    std::vector<std::string> want;
+    for (int i = 0; w.size() < 480; i++) {
+        std::string m = "GIB:FLOAT:" + std::to_string(268828928 + i) + ":" + std::to_string(i % 5) + ":22.5";
+        want.push_back(m);
+        w += m + "\n";
+    }
+    Split s = split(w);
+    TEST_ASSERT_GREATER_THAN(1, s.slots.size());
+    TEST_ASSERT_EQUAL(0, s.cuts);
+
+    std::vector<std::string> got = lines(s);
+    TEST_ASSERT_EQUAL(want.size(), got.size());
+    for (size_t i = 0; i < want.size(); i++) TEST_ASSERT_EQUAL_STRING(want[i].c_str(), got[i].c_str());
+}
+
+// A single line longer than a slot keeps its head, the lines after it survive
+static void test_overlong_line_is_cut_not_dropped() {
+    std::string big(300, 'X');
+    Split s = split("CAP?\n" + big + "\r\nFB:REAR:1");
+    TEST_ASSERT_EQUAL(1, s.cuts);
+
+    std::vector<std::string> got = lines(s);
+    TEST_ASSERT_EQUAL(3, got.size());
+    TEST_ASSERT_EQUAL_STRING("CAP?", got[0].c_str());
+    TEST_ASSERT_EQUAL(SLOT_LEN, got[1].size());
+    TEST_ASSERT_EQUAL_STRING("FB:REAR:1", got[2].c_str());
+
+    // no line break at all, as the old single-message writes came in
+    s = split(std::string(200, 'Y'));
+    TEST_ASSERT_EQUAL(1, s.slots.size());
+    TEST_ASSERT_EQUAL(1, s.cuts);
+    TEST_ASSERT_EQUAL(SLOT_LEN, s.slots[0].size());
+}
+
+// A line of exactly a slot is whole, nothing to count
+static void test_line_of_exactly_a_slot() {
+    std::string exact(SLOT_LEN, 'Z');
+    Split s = split(exact + "\nFB:REAR:0");
+    TEST_ASSERT_EQUAL(0, s.cuts);
+    std::vector<std::string> got = lines(s);
+    TEST_ASSERT_EQUAL(2, got.size());
+    TEST_ASSERT_EQUAL(SLOT_LEN, got[0].size());
+    TEST_ASSERT_EQUAL_STRING("FB:REAR:0", got[1].c_str());
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_short_write_is_one_slot);
+    RUN_TEST(test_mtu_sized_write_keeps_every_message);
+    RUN_TEST(test_overlong_line_is_cut_not_dropped);
+    RUN_TEST(test_line_of_exactly_a_slot);
+    return UNITY_END();
+}
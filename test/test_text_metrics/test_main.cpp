@@ -0,0 +1,121 @@
+#include <stdio.h>
+#include <string.h>
+#include <unity.h>
+
+#include "GfxReference.h"
+#include "TextMetrics.h"
+
+// Synthetic font over printable ASCII with the awkward cases real fonts
+// have: negative xOffset, zero-width glyphs, advance narrower than ink.
+static GFXglyph gGlyphs[0x7E - 0x20 + 1];
+static GFXfont gFont = {nullptr, gGlyphs, 0x20, 0x7E, 14};
+
+static void buildFont() {
+    for (int c = 0x20; c <= 0x7E; c++) {
+        GFXglyph& g = gGlyphs[c - 0x20];
+        g.bitmapOffset = 0;
+        g.width = (uint8_t)((c == ' ') ? 0 : 3 + (c * 7) % 6);
+        g.height = (uint8_t)(4 + c % 9);
+        g.xOffset = (int8_t)(c % 4 - 1);
+        g.yOffset = (int8_t)(-(int)g.height + c % 3);
+        g.xAdvance = (uint8_t)(g.width + c % 3);
+    }
+}
+
+static char gAscii[0x7E - 0x20 + 2];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void checkWidths(const GFXfont* font) {
+    for (uint8_t size = 1; size <= 4; size++) {
+        TextMetrics tm(font, size);
+        GfxReference ref;
+        ref.font = font;
+        ref.size = size;
+
+        for (int c = 0x20; c <= 0x7E; c++) {
+            char s[2] = {(char)c, 0};
+            char msg[32];
+            snprintf(msg, sizeof(msg), "'%c' size %u", c, size);
+            TEST_ASSERT_EQUAL_INT_MESSAGE(ref.width(s), tm.width(s, 1), msg);
+        }
+
+        // every run of the printable set, as wrapping measures them
+        size_t n = strlen(gAscii);
+        for (size_t i = 0; i < n; i += 7) {
+            for (size_t len = 1; i + len <= n; len += 5) {
+                char s[sizeof(gAscii)];
+                memcpy(s, gAscii + i, len);
+                s[len] = '\0';
+                TEST_ASSERT_EQUAL_INT(ref.width(s), tm.width(s, len));
+            }
+        }
+    }
+}
+
+static void test_builtin_font_matches_get_text_bounds(void) {
+    checkWidths(nullptr);
+}
+
+static void test_gfx_font_matches_get_text_bounds(void) {
+    checkWidths(&gFont);
+}
+
+// fit() against the prefix loop it replaced
+static void test_fit_matches_prefix_search(void) {
+    const GFXfont* fonts[] = {nullptr, &gFont};
+    for (const GFXfont* font : fonts) {
+        for (uint8_t size = 1; size <= 4; size++) {
+            TextMetrics tm(font, size);
+            GfxReference ref;
+            ref.font = font;
+            ref.size = size;
+
+            for (int16_t maxW = 1; maxW <= 230; maxW += 3) {
+                size_t want = 0;
+                char tmp[sizeof(gAscii)];
+                while (gAscii[want]) {
+                    memcpy(tmp, gAscii, want + 1);
+                    tmp[want + 1] = '\0';
+                    if (ref.width(tmp) > maxW) break;
+                    want++;
+                }
+                if (want == 0) want = 1;
+                TEST_ASSERT_EQUAL_UINT32(want, tm.fit(gAscii, strlen(gAscii), maxW));
+            }
+        }
+    }
+}
+
+static void test_line_height_and_ascent(void) {
+    const GFXfont* fonts[] = {nullptr, &gFont};
+    for (const GFXfont* font : fonts) {
+        for (uint8_t size = 1; size <= 4; size++) {
+            TextMetrics tm(font, size);
+            GfxReference ref;
+            ref.font = font;
+            ref.size = size;
+
+            // text drawn at y + ascent() starts exactly on row y
+            int16_t x1, y1;
+            uint16_t w, h;
+            ref.getTextBounds("Ay", 0, tm.ascent(), &x1, &y1, &w, &h);
+            TEST_ASSERT_EQUAL_INT(h, tm.lineHeight());
+            TEST_ASSERT_EQUAL_INT(0, y1);
+        }
+    }
+    TEST_ASSERT_EQUAL_INT(0, TextMetrics(nullptr, 2).ascent());
+}
+
+int main(int, char**) {
+    buildFont();
+    for (int c = 0x20; c <= 0x7E; c++) gAscii[c - 0x20] = (char)c;
+
+    UNITY_BEGIN();
+    RUN_TEST(test_builtin_font_matches_get_text_bounds);
+    RUN_TEST(test_gfx_font_matches_get_text_bounds);
+    RUN_TEST(test_fit_matches_prefix_search);
+    RUN_TEST(test_line_height_and_ascent);
+    return UNITY_END();
+}
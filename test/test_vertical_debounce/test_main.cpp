@@ -0,0 +1,140 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unity.h>
+
+#include "VerticalDebounce.h"
+
+// One channel the slow way: flip after 4 samples in a row that disagree
+struct ScalarDebounce {
+    bool state = false;
+    uint8_t run = 0;
+
+    bool update(bool sample) {
+        if (sample == state) {
+            run = 0;
+            return false;
+        }
+        if (++run < 4) return false;
+        state = sample;
+        run = 0;
+        return true;
+    }
+};
+
+// Key traces, one char per sample at BtnCfg::SAMPLE_US, '1' = pressed,
+// with contact bounce on press and on release
+static const char* const kClick =
+    "0000000000" "1010011011" "1111111111" "1111111111" "1111111111" "0101100010" "0000000000";
+static const char* const kLong =
+    "0000000000" "1100101111" "1111111111" "1111111111" "1111111111" "1111111111" "1111111111"
+    "1111111111" "1111111111" "1111111111" "1111111111" "0010100000" "0000000000";
+// EMI spikes and a dropout while held: never 4 samples long
+static const char* const kGlitch =
+    "0000010000" "0001100000" "0000011100" "0000000000" "1111111111" "1110111111" "1100111111"
+    "1110001111" "1111111111" "0000000000" "0000000000";
+
+static bool bit(const char* trace, size_t i) {
+    return i < strlen(trace) && trace[i] == '1';
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Replays each trace on its own channel, all at once, against the scalar model
+static void replayAgainstScalar(const char* const* traces, uint8_t n, uint32_t* downs, uint32_t* ups) {
+    VerticalDebounce vd;
+    ScalarDebounce ref[16];
+    size_t len = 0;
+    for (uint8_t c = 0; c < n; c++) if (strlen(traces[c]) > len) len = strlen(traces[c]);
+
+    for (size_t i = 0; i < len; i++) {
+        uint16_t sample = 0;
+        for (uint8_t c = 0; c < n; c++) if (bit(traces[c], i)) sample |= (uint16_t)(1u << c);
+
+        uint16_t flipped = vd.update(sample);
+        for (uint8_t c = 0; c < n; c++) {
+            bool f = ref[c].update(bit(traces[c], i));
+            TEST_ASSERT_EQUAL_INT(f, (flipped >> c) & 1);
+            TEST_ASSERT_EQUAL_INT(ref[c].state, (vd.state >> c) & 1);
+            if (f && ref[c].state) downs[c]++;
+            if (f && !ref[c].state) ups[c]++;
+        }
+        TEST_ASSERT_EQUAL_HEX16(0, flipped & ~(uint16_t)((1u << n) - 1));
+    }
+}
+
+static void test_bouncy_click_is_one_press(void) {
+    const char* traces[] = {kClick};
+    uint32_t downs[16] = {}, ups[16] = {};
+    replayAgainstScalar(traces, 1, downs, ups);
+    TEST_ASSERT_EQUAL_UINT32(1, downs[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, ups[0]);
+}
+
+// the press is reported on the 4th stable sample after the last bounce
+static void test_press_edge_lands_after_bounce(void) {
+    VerticalDebounce vd;
+    int at = -1;
+    for (size_t i = 0; i < strlen(kClick); i++) {
+        if (vd.update(bit(kClick, i) ? 1 : 0) && vd.state) at = (int)i;
+    }
+    // "1010011011": last 0 at index 17, then 18, 19, 20, 21
+    TEST_ASSERT_EQUAL_INT(21, at);
+}
+
+static void test_glitches_make_no_edges(void) {
+    const char* traces[] = {kGlitch};
+    uint32_t downs[16] = {}, ups[16] = {};
+    replayAgainstScalar(traces, 1, downs, ups);
+    TEST_ASSERT_EQUAL_UINT32(1, downs[0]);      // the real press at 40..89
+    TEST_ASSERT_EQUAL_UINT32(1, ups[0]);
+}
+
+// every channel bouncing at once, each with its own shifted trace
+static void test_channels_are_independent(void) {
+    static char shifted[16][256];
+    const char* traces[16];
+    const char* base[] = {kClick, kLong, kGlitch};
+    for (uint8_t c = 0; c < 16; c++) {
+        size_t pad = c * 3;
+        memset(shifted[c], '0', pad);
+        strcpy(shifted[c] + pad, base[c % 3]);
+        traces[c] = shifted[c];
+    }
+
+    uint32_t downs[16] = {}, ups[16] = {};
+    replayAgainstScalar(traces, 16, downs, ups);
+    for (uint8_t c = 0; c < 16; c++) {
+        TEST_ASSERT_EQUAL_UINT32(1, downs[c]);
+        TEST_ASSERT_EQUAL_UINT32(1, ups[c]);
+    }
+}
+
+static void test_random_noise_matches_scalar(void) {
+    VerticalDebounce vd;
+    ScalarDebounce ref[16];
+    srand(12345);
+
+    uint16_t level = 0;
+    for (int i = 0; i < 200000; i++) {
+        if ((rand() & 63) == 0) level ^= (uint16_t)(1u << (rand() & 15));
+        uint16_t noise = (uint16_t)(rand() & rand() & rand());
+        uint16_t sample = level ^ noise;
+
+        uint16_t flipped = vd.update(sample);
+        for (uint8_t c = 0; c < 16; c++) {
+            bool f = ref[c].update((sample >> c) & 1);
+            TEST_ASSERT_EQUAL_INT(f, (flipped >> c) & 1);
+        }
+    }
+}
+
+int main(int, char**) {
+    UNITY_BEGIN();
+    RUN_TEST(test_bouncy_click_is_one_press);
+    RUN_TEST(test_press_edge_lands_after_bounce);
+    RUN_TEST(test_glitches_make_no_edges);
+    RUN_TEST(test_channels_are_independent);
+    RUN_TEST(test_random_noise_matches_scalar);
+    return UNITY_END();
+}